@@ -0,0 +1,103 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include <QFile>
+#include <QTest>
+#include <QUrl>
+
+#include "PackageModel/ArchiveVerifier.h"
+
+class ArchiveVerifierTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void parseIndex();
+    void downloadList();
+
+private:
+    QString m_dataDir;
+    QHash<QString, ArchiveVerifier::IndexRecord> m_index;
+};
+
+void ArchiveVerifierTest::initTestCase()
+{
+    m_dataDir = QFINDTESTDATA("data/seed");
+    QVERIFY(!m_dataDir.isEmpty());
+
+    QFile file(m_dataDir + QLatin1String("/apt-cache-show.txt"));
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    m_index = ArchiveVerifier::parseIndex(file.readAll());
+}
+
+void ArchiveVerifierTest::parseIndex()
+{
+    // Records without a SHA256 are left out
+    QCOMPARE(m_index.size(), 4);
+    QVERIFY(!m_index.contains(QStringLiteral("unhashed=1.0")));
+
+    const ArchiveVerifier::IndexRecord hello = m_index.value(QStringLiteral("hello=2.10-3"));
+    QCOMPARE(hello.size, qint64(49));
+    QCOMPARE(hello.sha256, QByteArray("567bd61827733f8795161a300543e7c2cf743210c10d430a8368c643bad77c67"));
+
+    // Compared against QCryptographicHash's lower case hex
+    QCOMPARE(m_index.value(QStringLiteral("epoch=1:2.0")).sha256,
+             QByteArray("617e1a7c60a0c1cb118e7608559df8f811fe70fddd67bb01e8ec9dbf2fa1df1f"));
+}
+
+void ArchiveVerifierTest::downloadList()
+{
+    auto candidate = [this](const QString &name, const QString &version, const QString &architecture,
+                            const QString &file) {
+        return ArchiveVerifier::Candidate{ name, version, architecture, m_dataDir + QLatin1Char('/') + file };
+    };
+
+    const QVector<ArchiveVerifier::Candidate> candidates = {
+        candidate(QStringLiteral("hello"), QStringLiteral("2.10-3"), QStringLiteral("amd64"),
+                  QStringLiteral("hello_2.10-3_amd64.deb")),
+        // A version the index does not list
+        candidate(QStringLiteral("hello"), QStringLiteral("2.10-2"), QStringLiteral("amd64"),
+                  QStringLiteral("hello_2.10-3_amd64.deb")),
+        // Same size as listed, other contents
+        candidate(QStringLiteral("tampered"), QStringLiteral("1.0"), QStringLiteral("amd64"),
+                  QStringLiteral("tampered_1.0_amd64.deb")),
+        candidate(QStringLiteral("resized"), QStringLiteral("1.0"), QStringLiteral("amd64"),
+                  QStringLiteral("hello_2.10-3_amd64.deb")),
+        candidate(QStringLiteral("epoch"), QStringLiteral("1:2.0"), QStringLiteral("all"),
+                  QStringLiteral("epoch_2.0_all.deb")),
+        candidate(QStringLiteral("missing"), QStringLiteral("1.0"), QStringLiteral("amd64"),
+                  QStringLiteral("missing_1.0_amd64.deb")),
+    };
+
+    const QStringList lines = ArchiveVerifier::downloadList(candidates, m_index);
+    QCOMPARE(lines.size(), 2);
+
+    const QString helloUri = QUrl::fromLocalFile(m_dataDir + QLatin1String("/hello_2.10-3_amd64.deb"))
+            .toString(QUrl::FullyEncoded);
+    QCOMPARE(lines.at(0), QLatin1Char('\'') + helloUri + QLatin1String("' hello_2.10-3_amd64.deb 49 "
+             "SHA256:567bd61827733f8795161a300543e7c2cf743210c10d430a8368c643bad77c67"));
+
+    // APT names archives with the epoch's colon escaped
+    QVERIFY(lines.at(1).contains(QLatin1String("' epoch_1%3a2.0_all.deb 48 SHA256:617e1a7c")));
+}
+
+QTEST_GUILESS_MAIN(ArchiveVerifierTest)
+
+#include "ArchiveVerifierTest.moc"
@@ -0,0 +1,166 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QStandardPaths>
+#include <QTest>
+
+#include "DownloadModel/DownloadTelemetry.h"
+
+// Reports the time the test sets instead of the wall clock
+class SteppedTelemetry : public DownloadTelemetry
+{
+public:
+    qint64 now = 0;
+
+protected:
+    qint64 elapsedMs() const override { return now; }
+};
+
+class DownloadTelemetryTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void twoHosts();
+    void stalledHost();
+    void log();
+
+private:
+    // Two hosts as a local stand-in mirror would serve them: a.example
+    // finishes its item, b.example fails once, starts over and is halfway
+    static void feed(SteppedTelemetry *telemetry);
+};
+
+void DownloadTelemetryTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+static QApt::DownloadProgress progress(const QString &uri, QApt::DownloadStatus status,
+                                       quint64 fileSize, quint64 partialSize)
+{
+    return QApt::DownloadProgress(uri, status, uri.section(QLatin1Char('/'), -1),
+                                  fileSize, partialSize, QString());
+}
+
+void DownloadTelemetryTest::feed(SteppedTelemetry *telemetry)
+{
+    const QString a = QStringLiteral("http://a.example/pool/a.deb");
+    const QString b = QStringLiteral("http://b.example/pool/b.deb");
+
+    telemetry->start(QStringLiteral("/org/kubuntu/qaptworker/transaction42"));
+    telemetry->updateDetails(progress(a, QApt::FetchingState, 1000, 0));
+    telemetry->updateDetails(progress(b, QApt::FetchingState, 10000, 0));
+
+    telemetry->now = 200;
+    telemetry->updateDetails(progress(a, QApt::FetchingState, 1000, 500));
+    telemetry->now = 500;
+    telemetry->updateDetails(progress(b, QApt::FetchingState, 10000, 1000));
+    telemetry->now = 600;
+    telemetry->updateDetails(progress(b, QApt::ErrorState, 10000, 1000));
+    telemetry->now = 700;
+    telemetry->updateDetails(progress(b, QApt::FetchingState, 10000, 0));
+
+    telemetry->now = 1000;
+    telemetry->updateDetails(progress(a, QApt::DoneState, 1000, 1000));
+    telemetry->updateDetails(progress(b, QApt::FetchingState, 10000, 2000));
+}
+
+void DownloadTelemetryTest::twoHosts()
+{
+    SteppedTelemetry telemetry;
+    feed(&telemetry);
+
+    const QVector<DownloadTelemetry::HostStats> hosts = telemetry.hostStats();
+    QCOMPARE(hosts.size(), 2);
+
+    // Most bytes first
+    const DownloadTelemetry::HostStats &b = hosts.at(0);
+    QCOMPARE(b.host, QStringLiteral("b.example"));
+    QCOMPARE(b.totalBytes, qint64(3000));
+    QCOMPARE(b.bytesPerSecond, qint64(3000));
+    QCOMPARE(b.items, 1);
+    QCOMPARE(b.finishedItems, 0);
+    QCOMPARE(b.retries, 1);
+    QCOMPARE(b.errors, 0);
+    QCOMPARE(b.meanFirstByteMs, qint64(500));
+
+    const DownloadTelemetry::HostStats &a = hosts.at(1);
+    QCOMPARE(a.host, QStringLiteral("a.example"));
+    QCOMPARE(a.totalBytes, qint64(1000));
+    QCOMPARE(a.bytesPerSecond, qint64(1000));
+    QCOMPARE(a.finishedItems, 1);
+    QCOMPARE(a.retries, 0);
+    QCOMPARE(a.meanFirstByteMs, qint64(200));
+
+    QCOMPARE(telemetry.bytesPerSecond(), qint64(4000));
+    // 8000 bytes of b.example left at 4000 bytes a second
+    QCOMPARE(telemetry.eta(), qint64(2));
+}
+
+void DownloadTelemetryTest::stalledHost()
+{
+    SteppedTelemetry telemetry;
+    feed(&telemetry);
+
+    // Nothing arrived for longer than the window
+    telemetry.now = 7000;
+    QCOMPARE(telemetry.bytesPerSecond(), qint64(0));
+    QCOMPARE(telemetry.eta(), qint64(-1));
+    for (const DownloadTelemetry::HostStats &host : telemetry.hostStats()) {
+        QCOMPARE(host.bytesPerSecond, qint64(0));
+    }
+}
+
+void DownloadTelemetryTest::log()
+{
+    SteppedTelemetry telemetry;
+    feed(&telemetry);
+
+    const QString path = telemetry.writeLog(QStringLiteral("success"));
+    QVERIFY(!path.isEmpty());
+    QVERIFY(path.endsWith(QLatin1String("-transaction42.json")));
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    QCOMPARE(root.value(QStringLiteral("outcome")).toString(), QStringLiteral("success"));
+    QCOMPARE(root.value(QStringLiteral("downloadMs")).toInt(), 1000);
+    QCOMPARE(root.value(QStringLiteral("items")).toArray().size(), 2);
+
+    const QJsonArray hosts = root.value(QStringLiteral("hosts")).toArray();
+    QCOMPARE(hosts.size(), 2);
+    const QJsonObject b = hosts.at(0).toObject();
+    QCOMPARE(b.value(QStringLiteral("host")).toString(), QStringLiteral("b.example"));
+    QCOMPARE(b.value(QStringLiteral("averageBytesPerSecond")).toInt(), 3000);
+    QCOMPARE(b.value(QStringLiteral("retries")).toInt(), 1);
+    QCOMPARE(b.value(QStringLiteral("meanFirstByteMs")).toInt(), 500);
+
+    QDir(QFileInfo(path).absolutePath()).removeRecursively();
+}
+
+QTEST_GUILESS_MAIN(DownloadTelemetryTest)
+
+#include "DownloadTelemetryTest.moc"
@@ -0,0 +1,107 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include <QFile>
+#include <QSignalSpy>
+#include <QStandardPaths>
+#include <QTest>
+
+#include "PackageModel/FlatpakCatalog.h"
+
+class FlatpakCatalogTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void parse();
+    void load();
+
+private:
+    QString m_root;
+};
+
+void FlatpakCatalogTest::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QFile::remove(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+                  + QLatin1String("/flatpak-catalog"));
+
+    m_root = QFINDTESTDATA("data/flatpak");
+    QVERIFY(!m_root.isEmpty());
+}
+
+void FlatpakCatalogTest::parse()
+{
+    QFile file(m_root + QLatin1String("/flathub/x86_64/active/appstream.xml"));
+    QVERIFY(file.open(QIODevice::ReadOnly));
+
+    // Runtimes are left out
+    const QList<FlatpakPackage> packages = FlatpakCatalog::parse(&file, QStringLiteral("flathub"));
+    QCOMPARE(packages.size(), 2);
+
+    const FlatpakPackage &kate = packages.at(0);
+    QCOMPARE(kate.id, QStringLiteral("org.kde.kate"));
+    QCOMPARE(kate.arch, QStringLiteral("x86_64"));
+    QCOMPARE(kate.branch, QStringLiteral("stable"));
+    QCOMPARE(kate.remote, QStringLiteral("flathub"));
+    QCOMPARE(kate.name, QStringLiteral("Kate"));
+    QCOMPARE(kate.description, QStringLiteral("Advanced text editor"));
+    // The newest release, with its download rather than installed size
+    QCOMPARE(kate.version, QStringLiteral("24.02.1"));
+    QCOMPARE(kate.downloadSize, qint64(12582912));
+    QVERIFY(!kate.isInstalled);
+
+    // Named by its id when the catalog has no name
+    const FlatpakPackage &unnamed = packages.at(1);
+    QCOMPARE(unnamed.name, QStringLiteral("org.example.Unnamed"));
+    QCOMPARE(unnamed.version, QString());
+    QCOMPARE(unnamed.downloadSize, qint64(0));
+}
+
+void FlatpakCatalogTest::load()
+{
+    FlatpakCatalog catalog;
+    catalog.setCatalogRoots({ m_root });
+
+    // Parsed the first time, read back from the cache the second
+    for (int pass = 0; pass < 2; ++pass) {
+        QSignalSpy readySpy(&catalog, &FlatpakCatalog::ready);
+        catalog.load();
+        QVERIFY(readySpy.wait());
+        QVERIFY(catalog.isReady());
+
+        QCOMPARE(catalog.packages().size(), 3);
+
+        // Offered by both remotes, listed once from the first in name order
+        QVERIFY(catalog.contains(QStringLiteral("org.kde.kate")));
+        QCOMPARE(catalog.package(QStringLiteral("org.kde.kate")).remote, QStringLiteral("flathub"));
+
+        const FlatpakPackage okular = catalog.package(QStringLiteral("org.kde.okular"));
+        QCOMPARE(okular.remote, QStringLiteral("kdeapps"));
+        QCOMPARE(okular.version, QStringLiteral("24.05.0"));
+        QCOMPARE(okular.downloadSize, qint64(8388608));
+
+        QVERIFY(!catalog.contains(QStringLiteral("org.kde.Platform")));
+    }
+}
+
+QTEST_GUILESS_MAIN(FlatpakCatalogTest)
+
+#include "FlatpakCatalogTest.moc"
@@ -18,14 +18,236 @@
  */
 
 #include "AppStreamHelper.h"
+#include <QCryptographicHash>
+#include <QDataStream>
 #include <QDebug>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QStringBuilder>
+#include <QtConcurrent>
 
 #ifdef HAVE_APPSTREAM
+#include <AppStreamQt5/pool.h>
+#include <AppStreamQt5/component.h>
 #include <AppStreamQt5/screenshot.h>
 #include <AppStreamQt5/image.h>
 #include <AppStreamQt5/icon.h>
+#include <AppStreamQt5/launchable.h>
 #endif
 
+#ifdef HAVE_APPSTREAM
+// Bump when the layout of the cached index changes
+static const quint32 s_indexCacheVersion = 1;
+
+// Where distributions put AppStream catalog data, and where installed
+// software drops its own metainfo, which the pool loads as well
+static const char *const s_catalogDirs[] = {
+    "/usr/share/swcatalog",
+    "/usr/share/app-info",
+    "/var/lib/swcatalog",
+    "/var/lib/app-info",
+    "/var/cache/swcatalog",
+    "/var/cache/app-info",
+    "/usr/share/metainfo",
+    "/usr/share/appdata"
+};
+
+QDataStream &operator<<(QDataStream &stream, const AppStreamInfo &info)
+{
+    return stream << info.name << info.description << info.iconUrl << info.screenshotUrl;
+}
+
+QDataStream &operator>>(QDataStream &stream, AppStreamInfo &info)
+{
+    return stream >> info.name >> info.description >> info.iconUrl >> info.screenshotUrl;
+}
+
+static QString indexCachePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+            + QLatin1String("/appstream-index");
+}
+
+// Identifies the state of the catalogs the index was built from
+static QByteArray catalogFingerprint()
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (const char *dir : s_catalogDirs) {
+        // Only the catalogs themselves; the icon caches next to them are huge
+        QDirIterator it(QString::fromLatin1(dir),
+                        { QStringLiteral("*.xml*"), QStringLiteral("*.yml*"), QStringLiteral("*.yaml*") },
+                        QDir::Files, QDirIterator::Subdirectories);
+        QStringList entries;
+        while (it.hasNext()) {
+            it.next();
+            const QFileInfo info = it.fileInfo();
+            entries.append(info.filePath() % QLatin1Char(' ')
+                           % QString::number(info.size()) % QLatin1Char(' ')
+                           % QString::number(info.lastModified().toMSecsSinceEpoch()));
+        }
+        entries.sort();
+        for (const QString &entry : qAsConst(entries)) {
+            hash.addData(entry.toUtf8());
+        }
+    }
+    return hash.result();
+}
+
+static bool readIndexCache(const QByteArray &fingerprint, AppStreamIndex *index)
+{
+    QFile file(indexCachePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    quint32 version = 0;
+    QByteArray cachedFingerprint;
+    stream >> version >> cachedFingerprint;
+    if (version != s_indexCacheVersion || cachedFingerprint != fingerprint) {
+        return false;
+    }
+
+    stream >> *index;
+    return stream.status() == QDataStream::Ok;
+}
+
+static void writeIndexCache(const QByteArray &fingerprint, const AppStreamIndex &index)
+{
+    QDir().mkpath(QFileInfo(indexCachePath()).absolutePath());
+
+    QSaveFile file(indexCachePath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream << s_indexCacheVersion << fingerprint << index;
+    file.commit();
+}
+
+static AppStreamInfo componentInfo(const AppStream::Component &comp)
+{
+    AppStreamInfo info;
+    info.name = comp.name();
+    info.description = comp.description();
+
+    const QList<AppStream::Icon> icons = comp.icons();
+    for (const auto &icon : icons) {
+        if (icon.kind() == AppStream::Icon::KindRemote) {
+            info.iconUrl = icon.url().toString();
+            break;
+        }
+    }
+
+    const QList<AppStream::Screenshot> screenshots = comp.screenshotsAll();
+    if (!screenshots.isEmpty()) {
+        // Prefer source image (highest res) of the default screenshot
+        const QList<AppStream::Image> images = screenshots.first().images();
+        for (const auto &img : images) {
+            if (img.kind() == AppStream::Image::KindSource) {
+                info.screenshotUrl = img.url().toString();
+                break;
+            }
+        }
+        if (info.screenshotUrl.isEmpty() && !images.isEmpty()) {
+            info.screenshotUrl = images.first().url().toString();
+        }
+    }
+
+    return info;
+}
+
+static AppStreamIndex buildIndex()
+{
+    AppStreamIndex index;
+
+    AppStream::Pool pool;
+    if (!pool.load()) {
+        qWarning() << "Failed to load AppStream metadata pool";
+        return index;
+    }
+
+    // A package name matches, in order of preference: the desktop file it
+    // launches, a component named after its desktop file, or a component
+    // listing it among its packages (the application one if there are several).
+    QHash<QString, AppStream::Component> desktopIds;
+    QHash<QString, AppStream::Component> ids;
+    QHash<QString, AppStream::Component> packages;
+
+    const auto allComponents = pool.components();
+    for (const auto &comp : allComponents) {
+        const QStringList desktopIdList = comp.launchable(AppStream::Launchable::KindDesktopId).entries();
+        for (const QString &desktopId : desktopIdList) {
+            if (desktopId.endsWith(QLatin1String(".desktop"))) {
+                const QString name = desktopId.chopped(8);
+                if (!desktopIds.contains(name)) {
+                    desktopIds.insert(name, comp);
+                }
+            }
+        }
+
+        if (comp.id().endsWith(QLatin1String(".desktop"))) {
+            const QString name = comp.id().chopped(8);
+            if (!ids.contains(name)) {
+                ids.insert(name, comp);
+            }
+        }
+
+        const QStringList packageNames = comp.packageNames();
+        for (const QString &packageName : packageNames) {
+            auto it = packages.find(packageName);
+            if (it == packages.end()) {
+                packages.insert(packageName, comp);
+            } else if (it->kind() != AppStream::Component::KindDesktopApp
+                       && comp.kind() == AppStream::Component::KindDesktopApp) {
+                *it = comp;
+            }
+        }
+    }
+
+    for (auto it = packages.constBegin(); it != packages.constEnd(); ++it) {
+        index.insert(it.key(), componentInfo(it.value()));
+    }
+    for (auto it = ids.constBegin(); it != ids.constEnd(); ++it) {
+        index.insert(it.key(), componentInfo(it.value()));
+    }
+    for (auto it = desktopIds.constBegin(); it != desktopIds.constEnd(); ++it) {
+        index.insert(it.key(), componentInfo(it.value()));
+    }
+
+    return index;
+}
+#endif
+
+static AppStreamIndex loadIndex()
+{
+#ifdef HAVE_APPSTREAM
+    QElapsedTimer timer;
+    timer.start();
+
+    const QByteArray fingerprint = catalogFingerprint();
+    AppStreamIndex index;
+    if (readIndexCache(fingerprint, &index)) {
+        qDebug() << "AppStream index read from cache in" << timer.elapsed() << "ms";
+        return index;
+    }
+
+    index = buildIndex();
+    writeIndexCache(fingerprint, index);
+    qDebug() << "AppStream metadata loaded and indexed in" << timer.elapsed() << "ms";
+    return index;
+#else
+    // Nothing could rebuild the index, so there is no point walking the catalogs
+    return AppStreamIndex();
+#endif
+}
+
 AppStreamHelper *AppStreamHelper::instance()
 {
     static AppStreamHelper s_instance;
@@ -34,26 +256,33 @@ AppStreamHelper *AppStreamHelper::instance()
 
 AppStreamHelper::AppStreamHelper(QObject *parent)
     : QObject(parent)
+    , m_watcher(new QFutureWatcher<AppStreamIndex>(this))
     , m_initialized(false)
+    , m_ready(false)
 {
+    connect(m_watcher, &QFutureWatcher<AppStreamIndex>::finished,
+            this, &AppStreamHelper::loadFinished);
 }
 
 AppStreamHelper::~AppStreamHelper()
 {
+    m_watcher->waitForFinished();
 }
 
 void AppStreamHelper::init()
 {
     if (m_initialized) return;
-
-#ifdef HAVE_APPSTREAM
-    if (!m_pool.load()) {
-        qWarning() << "Failed to load AppStream metadata pool";
-    } else {
-        qDebug() << "AppStream metadata loaded successfully";
-    }
-#endif
     m_initialized = true;
+
+    // Parsing the catalogs takes seconds, keep it off the startup path
+    m_watcher->setFuture(QtConcurrent::run(loadIndex));
+}
+
+void AppStreamHelper::loadFinished()
+{
+    m_index = m_watcher->result();
+    m_ready = true;
+    emit ready();
 }
 
 bool AppStreamHelper::isAvailable() const
@@ -65,119 +294,34 @@ bool AppStreamHelper::isAvailable() const
 #endif
 }
 
-#ifdef HAVE_APPSTREAM
-AppStream::Component AppStreamHelper::findComponent(const QString &packageName) const
+bool AppStreamHelper::isReady() const
 {
-    if (m_componentCache.contains(packageName)) {
-        return m_componentCache.value(packageName);
-    }
-
-    // Search by package name
-    // Note: This is a simplified search. Ideally we should match against the package name provided by the component.
-    QList<AppStream::Component> components = m_pool.componentsByLaunchable(AppStream::Launchable::KindDesktopId, packageName + ".desktop").toList();
-    
-    if (components.isEmpty()) {
-        // Try searching by package name directly if supported or iterate
-        // For now, let's try a broader search or just return invalid
-        // Some components might not have the .desktop suffix in their ID
-         components = m_pool.componentsById(packageName + ".desktop").toList();
-    }
-    
-    // Fallback: Iterate and check package names (expensive, maybe optimize later)
-    if (components.isEmpty()) {
-         const auto allComponents = m_pool.components();
-         for (const auto &comp : allComponents) {
-             if (comp.packageNames().contains(packageName)) {
-                 m_componentCache.insert(packageName, comp);
-                 return comp;
-             }
-         }
-    }
-
-    if (!components.isEmpty()) {
-        m_componentCache.insert(packageName, components.first());
-        return components.first();
-    }
-
-    return AppStream::Component();
+    return m_ready;
 }
-#endif
 
 QString AppStreamHelper::getGenericName(const QString &packageName) const
 {
-#ifdef HAVE_APPSTREAM
-    auto comp = findComponent(packageName);
-    if (comp.isValid()) {
-        return comp.name(); // Or genericName() if preferred, but name() is usually better for display
-    }
-#endif
-    return QString();
+    return m_index.value(packageName).name;
 }
 
 QString AppStreamHelper::getLongDescription(const QString &packageName) const
 {
-#ifdef HAVE_APPSTREAM
-    auto comp = findComponent(packageName);
-    if (comp.isValid()) {
-        return comp.description();
-    }
-#endif
-    return QString();
+    return m_index.value(packageName).description;
 }
 
 QString AppStreamHelper::getIconUrl(const QString &packageName) const
 {
-#ifdef HAVE_APPSTREAM
-    auto comp = findComponent(packageName);
-    if (comp.isValid()) {
-        QList<AppStream::Icon> icons = comp.icons();
-        for (const auto &icon : icons) {
-            if (icon.kind() == AppStream::Icon::KindRemote) {
-                return icon.url().toString();
-            }
-        }
-    }
-#endif
-    return QString();
+    return m_index.value(packageName).iconUrl;
 }
 
 QString AppStreamHelper::getScreenshotUrl(const QString &packageName) const
 {
-#ifdef HAVE_APPSTREAM
-    auto comp = findComponent(packageName);
-    if (comp.isValid()) {
-        QList<AppStream::Screenshot> screenshots = comp.screenshotsAll();
-        if (!screenshots.isEmpty()) {
-            // Get default screenshot
-            auto screenshot = screenshots.first();
-            // Prefer source image (highest res) or large thumbnail
-            QList<AppStream::Image> images = screenshot.images();
-            for (const auto &img : images) {
-                if (img.kind() == AppStream::Image::KindSource) {
-                    return img.url().toString();
-                }
-            }
-            if (!images.isEmpty()) {
-                 return images.first().url().toString();
-            }
-        }
-    }
-#endif
-    return QString();
+    return m_index.value(packageName).screenshotUrl;
 }
 
 QColor AppStreamHelper::getBrandColor(const QString &packageName) const
 {
-#ifdef HAVE_APPSTREAM
-    auto comp = findComponent(packageName);
-    if (comp.isValid()) {
-        // AppStreamQt5 might not expose branding colors directly in older versions
-        // Checking available API... assuming standard metadata access
-        // If not available, we return invalid color
-        // Note: As of AppStreamQt 0.15+, branding might be available via custom keys or newer API
-        // For now, let's return invalid to be safe unless we find a specific API
-        return QColor(); 
-    }
-#endif
+    // AppStreamQt5 does not expose branding colors; keep the API for when it does
+    Q_UNUSED(packageName)
     return QColor();
 }
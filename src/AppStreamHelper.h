@@ -21,15 +21,20 @@
 #define APPSTREAMHELPER_H
 
 #include <QObject>
-#include <QMap>
+#include <QHash>
 #include <QString>
 #include <QColor>
-#include <QSharedPointer>
+#include <QFutureWatcher>
 
-#ifdef HAVE_APPSTREAM
-#include <AppStreamQt5/pool.h>
-#include <AppStreamQt5/component.h>
-#endif
+// What we use of a component, so the pool itself need not stay loaded
+struct AppStreamInfo {
+    QString name;
+    QString description;
+    QString iconUrl;
+    QString screenshotUrl;
+};
+
+typedef QHash<QString, AppStreamInfo> AppStreamIndex;
 
 class AppStreamHelper : public QObject
 {
@@ -38,27 +43,33 @@ class AppStreamHelper : public QObject
 public:
     static AppStreamHelper *instance();
     
+    // Starts loading the metadata in the background; emits ready() when done
     void init();
     bool isAvailable() const;
+    bool isReady() const;
     
-    // Metadata retrieval
+    // Metadata retrieval. Empty until ready() has been emitted.
     QString getGenericName(const QString &packageName) const;
     QString getLongDescription(const QString &packageName) const;
     QString getIconUrl(const QString &packageName) const;
     QString getScreenshotUrl(const QString &packageName) const;
     QColor getBrandColor(const QString &packageName) const;
+
+Q_SIGNALS:
+    void ready();
     
 private:
     explicit AppStreamHelper(QObject *parent = nullptr);
     ~AppStreamHelper();
-    
-#ifdef HAVE_APPSTREAM
-    AppStream::Pool m_pool;
-    mutable QMap<QString, AppStream::Component> m_componentCache;
-    
-    AppStream::Component findComponent(const QString &packageName) const;
-#endif
+
+    // Package name -> metadata of the component best matching it
+    AppStreamIndex m_index;
+    QFutureWatcher<AppStreamIndex> *m_watcher;
     bool m_initialized;
+    bool m_ready;
+
+private Q_SLOTS:
+    void loadFinished();
 };
 
 #endif // APPSTREAMHELPER_H
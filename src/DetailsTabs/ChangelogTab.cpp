@@ -21,15 +21,9 @@
 #include "ChangelogTab.h"
 
 // Qt includes
-#include <QDir>
-#include <QtCore/QTextStream>
-#include <QTemporaryFile>
 #include <QTextBrowser>
-#include <QUrl>
 
 // KDE includes
-#include <KIO/Job>
-#include <KJob>
 #include <KLocalizedString>
 #include <KPixmapSequence>
 #include <KPixmapSequenceOverlayPainter>
@@ -39,8 +33,12 @@
 #include <QApt/Package>
 #include <QApt/Changelog>
 
+// Own includes
+#include "muonapt/ChangelogCache.h"
+
 ChangelogTab::ChangelogTab(QWidget *parent)
     : DetailsTab(parent)
+    , m_localOnly(false)
 {
     m_name = i18nc("@title:tab", "Changes List");
 
@@ -52,6 +50,11 @@ ChangelogTab::ChangelogTab(QWidget *parent)
     m_busyWidget->setWidget(m_changelogBrowser->viewport());
 
     m_layout->addWidget(m_changelogBrowser);
+
+    connect(ChangelogCache::instance(), &ChangelogCache::changelogReady,
+            this, &ChangelogTab::changelogReady);
+    connect(ChangelogCache::instance(), &ChangelogCache::changelogFailed,
+            this, &ChangelogTab::changelogFailed);
 }
 
 void ChangelogTab::setPackage(QApt::Package *package)
@@ -68,44 +71,70 @@ void ChangelogTab::clear()
 {
     DetailsTab::clear();
 
-    // Delete any KJobs lying around. We could get stale package pointers if the jobs
-    // finish during a cache reload
-    auto iter = m_jobFilenames.constBegin();
-    while (iter != m_jobFilenames.constEnd()) {
-        iter.key()->deleteLater();
-        ++iter;
-    }
-
-    m_jobFilenames.clear();
+    // Results still on their way belong to a package pointer that may go
+    // away with a cache reload
+    m_source.clear();
+    m_installedVersion.clear();
+    m_candidateVersion.clear();
+    m_shownVersion.clear();
+    m_localOnly = false;
 }
 
-void ChangelogTab::changelogFetched(KJob *job)
+void ChangelogTab::changelogReady(const QString &source, const QString &version,
+                                  const QApt::Changelog &changelog)
 {
+    if (!m_package || source != m_source) {
+        return;
+    }
+
+    // The installed copy may arrive after the candidate's, which has the
+    // newer entries
+    if (version == m_installedVersion && m_shownVersion == m_candidateVersion
+            && !m_shownVersion.isEmpty()) {
+        return;
+    }
+    if (version != m_installedVersion && version != m_candidateVersion) {
+        return;
+    }
+
+    m_shownVersion = version;
+    m_busyWidget->stop();
+
     // Work around http://bugreports.qt.nokia.com/browse/QTBUG-2533 by forcibly resetting the CharFormat
     QTextCharFormat format;
     m_changelogBrowser->setCurrentCharFormat(format);
-    QFile changelogFile(m_jobFilenames[job]);
+    m_changelogBrowser->setText(changelog.text());
+}
 
-    m_jobFilenames.remove(job);
+void ChangelogTab::changelogFailed(const QString &source, const QString &version)
+{
+    if (!m_package || source != m_source || !m_shownVersion.isEmpty()) {
+        return;
+    }
 
-    m_busyWidget->stop();
-    if (job->error() || !changelogFile.open(QFile::ReadOnly)) {
-        if (m_package->origin() == QStringLiteral("Ubuntu")) {
-            m_changelogBrowser->setText(xi18nc("@info/rich", "The list of changes is not yet available. "
-                                               "Please use <link url='%1'>Launchpad</link> instead.",
-                                               QStringLiteral("http://launchpad.net/ubuntu/+source/") + m_package->sourcePackage()));
-        } else {
-            m_changelogBrowser->setText(i18nc("@info", "The list of changes is not yet available."));
-        }
+    // Some packages ship no changelog in /usr/share/doc, try the network
+    if (m_localOnly && version == m_installedVersion) {
+        m_localOnly = false;
+        ChangelogCache::instance()->fetch(m_source, m_candidateVersion, ChangelogCache::changelogUrl(m_package));
+        return;
+    }
+
+    // Wait for the other request, if any, before giving up
+    if (version == m_installedVersion && m_candidateVersion != m_installedVersion) {
+        return;
     }
-    else {
-        QTextStream stream(&changelogFile);
-        const QApt::Changelog log(stream.readAll(), m_package->sourcePackage());
-        m_changelogBrowser->setText(log.text());
+    if (version != m_candidateVersion && version != m_installedVersion) {
+        return;
     }
 
-    changelogFile.remove();
-    job->deleteLater();
+    m_busyWidget->stop();
+    if (m_package->origin() == QStringLiteral("Ubuntu")) {
+        m_changelogBrowser->setText(xi18nc("@info/rich", "The list of changes is not yet available. "
+                                           "Please use <link url='%1'>Launchpad</link> instead.",
+                                           QStringLiteral("http://launchpad.net/ubuntu/+source/") + m_package->sourcePackage()));
+    } else {
+        m_changelogBrowser->setText(i18nc("@info", "The list of changes is not yet available."));
+    }
 }
 
 void ChangelogTab::fetchChangelog()
@@ -117,17 +146,18 @@ void ChangelogTab::fetchChangelog()
     m_changelogBrowser->clear();
     m_busyWidget->start();
 
-    QTemporaryFile *changelogFile = new QTemporaryFile(QDir::tempPath() + QLatin1String("/muon_XXXXXX.txt"));
-    changelogFile->setAutoRemove(false);
-    changelogFile->open();
-    QString filename = changelogFile->fileName();
-    delete changelogFile;
-
-    KIO::FileCopyJob *getJob = KIO::file_copy(m_package->changelogUrl(),
-                               QUrl::fromLocalFile(filename), -1,
-                               KIO::Overwrite | KIO::HideProgressInfo);
-    getJob->setAutoDelete(false);
-    m_jobFilenames.insert(getJob, filename);
-    connect(getJob, SIGNAL(result(KJob*)),
-            this, SLOT(changelogFetched(KJob*)));
+    m_source = m_package->sourcePackage();
+    m_installedVersion = m_package->installedVersion();
+    m_candidateVersion = m_package->availableVersion();
+    m_shownVersion.clear();
+    m_localOnly = m_package->isInstalled() && m_candidateVersion == m_installedVersion;
+
+    ChangelogCache *cache = ChangelogCache::instance();
+    if (m_package->isInstalled()) {
+        // Show what dpkg installed right away, no network needed
+        cache->fetchLocal(m_package->name(), m_source, m_installedVersion);
+    }
+    if (!m_package->isInstalled() || m_candidateVersion != m_installedVersion) {
+        cache->fetch(m_source, m_candidateVersion, ChangelogCache::changelogUrl(m_package));
+    }
 }
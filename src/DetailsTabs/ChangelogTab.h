@@ -23,14 +23,13 @@
 
 #include "DetailsTab.h"
 
-// Qt includes
-#include <QtCore/QHash>
-
 class QTextBrowser;
 
-class KJob;
 class KPixmapSequenceOverlayPainter;
-class KTemporaryFile;
+
+namespace QApt {
+    class Changelog;
+}
 
 class ChangelogTab : public DetailsTab
 {
@@ -41,16 +40,24 @@ public:
 private:
     QTextBrowser *m_changelogBrowser;
     KPixmapSequenceOverlayPainter *m_busyWidget;
-    QHash<KJob *, QString> m_jobFilenames;
+
+    // What the current package's changelog has been requested for
+    QString m_source;
+    QString m_installedVersion;
+    QString m_candidateVersion;
+    QString m_shownVersion;
+    // Only the installed copy was asked for, as it is also the candidate
+    bool m_localOnly;
 
 public Q_SLOTS:
     void setPackage(QApt::Package *package);
     void refresh() override;
-    void clear();
+    void clear() override;
 
 private Q_SLOTS:
     void fetchChangelog();
-    void changelogFetched(KJob *job);
+    void changelogReady(const QString &source, const QString &version, const QApt::Changelog &changelog);
+    void changelogFailed(const QString &source, const QString &version);
 };
 
 #endif
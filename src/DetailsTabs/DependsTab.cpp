@@ -31,6 +31,10 @@
 // QApt includes
 #include <QApt/Package>
 
+// Own includes
+#include "muonapt/DependencyGraph.h"
+#include "muonapt/MuonStrings.h"
+
 DependsTab::DependsTab(QWidget *parent)
     : DetailsTab(parent)
 {
@@ -46,6 +50,8 @@ DependsTab::DependsTab(QWidget *parent)
 
     m_layout->addWidget(m_comboBox);
     m_layout->addWidget(m_dependsBrowser);
+
+    connect(DependencyGraph::instance(), &DependencyGraph::ready, this, &DependsTab::refresh);
 }
 
 void DependsTab::refresh()
@@ -80,7 +86,12 @@ void DependsTab::populateDepends(int index)
         }
         break;
     case ReverseDependsType:
-        list = m_package->requiredByList();
+        if (!DependencyGraph::instance()->isReady()) {
+            // Refreshed once the graph is there
+            m_dependsBrowser->append(i18nc("@label", "The dependants of this package are still being calculated..."));
+            return;
+        }
+        list = dependantsList();
         if (list.isEmpty()) {
             m_dependsBrowser->append(i18nc("@label", "This package has no dependents. (Nothing depends on it.)"));
             return;
@@ -104,4 +115,20 @@ void DependsTab::populateDepends(int index)
     m_dependsBrowser->setTextCursor(cursor);
 }
 
+QStringList DependsTab::dependantsList() const
+{
+    QStringList list;
+    const DependencyGraphSnapshot graph = DependencyGraph::instance()->snapshot();
+    const int node = graph ? graph->nodeOf(m_package) : -1;
+    if (node == -1) {
+        return list;
+    }
+
+    for (const DependencyGraphData::Dependant &dependant : graph->dependantList(node)) {
+        list.append(i18nc("@label dependency type: package name", "<b>%1</b>: %2",
+                          MuonStrings::global()->dependencyTypeName(dependant.type),
+                          graph->nodeName(dependant.node)));
+    }
 
+    return list;
+}
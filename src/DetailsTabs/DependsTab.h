@@ -44,6 +44,8 @@ private:
     KComboBox *m_comboBox;
     QTextBrowser *m_dependsBrowser;
 
+    QStringList dependantsList() const;
+
 public Q_SLOTS:
     void refresh();
 
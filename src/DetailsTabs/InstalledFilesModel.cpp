@@ -0,0 +1,239 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "InstalledFilesModel.h"
+
+// Qt includes
+#include <QFile>
+#include <QStringBuilder>
+#include <QtConcurrent>
+
+// QApt includes
+#include <QApt/Package>
+
+// Rows handed to the view per fetchMore() call
+static const int s_fetchBatchSize = 2000;
+
+QStringList InstalledFilesModel::readFileList(const QString &name, const QString &arch)
+{
+    // Same lookup order as libapt-pkg: multiarch name first, then plain name
+    const QString infoDir = QStringLiteral("/var/lib/dpkg/info/");
+    QFile file(infoDir % name % QLatin1Char(':') % arch % QLatin1String(".list"));
+    if (!file.exists()) {
+        file.setFileName(infoDir % name % QLatin1String(".list"));
+    }
+
+    QStringList files;
+    if (!file.open(QIODevice::ReadOnly)) {
+        return files;
+    }
+
+    const QList<QByteArray> lines = file.readAll().split('\n');
+    files.reserve(lines.size());
+    for (const QByteArray &line : lines) {
+        // Skip the "/." entry every package list starts with
+        if (line.isEmpty() || line == "/.") {
+            continue;
+        }
+        files.append(QString::fromUtf8(line));
+    }
+
+    files.sort();
+    return files;
+}
+
+InstalledFilesModel::InstalledFilesModel(QObject *parent)
+    : QAbstractListModel(parent)
+    , m_watcher(new QFutureWatcher<QStringList>(this))
+    , m_generation(0)
+    , m_loadGeneration(-1)
+    , m_fetched(0)
+{
+    connect(m_watcher, &QFutureWatcher<QStringList>::finished,
+            this, &InstalledFilesModel::loadFinished);
+}
+
+int InstalledFilesModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_fetched;
+}
+
+QVariant InstalledFilesModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_fetched) {
+        return QVariant();
+    }
+
+    switch (role) {
+    case Qt::DisplayRole:
+    case Qt::ToolTipRole:
+        return m_files.at(m_matches.at(index.row()));
+    }
+
+    return QVariant();
+}
+
+bool InstalledFilesModel::canFetchMore(const QModelIndex &parent) const
+{
+    return !parent.isValid() && m_fetched < m_matches.size();
+}
+
+void InstalledFilesModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid()) {
+        return;
+    }
+
+    const int count = qMin(s_fetchBatchSize, m_matches.size() - m_fetched);
+    if (count <= 0) {
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), m_fetched, m_fetched + count - 1);
+    m_fetched += count;
+    endInsertRows();
+}
+
+void InstalledFilesModel::setPackage(QApt::Package *package)
+{
+    // Marking changes refresh the details tabs; keep the list (and the
+    // view's scroll position) when the installed package did not change.
+    if (package && package->isInstalled() && packageKey(package) == m_packageKey) {
+        return;
+    }
+
+    clear();
+
+    if (!package || !package->isInstalled()) {
+        return;
+    }
+
+    const QString name = package->name();
+    const QString arch = package->architecture();
+    m_packageKey = packageKey(package);
+    m_loadGeneration = m_generation;
+    m_watcher->setFuture(QtConcurrent::run([name, arch]() {
+        return readFileList(name, arch);
+    }));
+    emit loadingChanged(true);
+}
+
+QString InstalledFilesModel::packageKey(QApt::Package *package)
+{
+    return package->name() % QLatin1Char(':') % package->architecture()
+            % QLatin1Char('=') % package->installedVersion();
+}
+
+QString InstalledFilesModel::packageKey() const
+{
+    return m_packageKey;
+}
+
+void InstalledFilesModel::setFilterText(const QString &text)
+{
+    const QString filter = text.trimmed();
+    if (filter == m_filterText) {
+        return;
+    }
+
+    // A filter that contains the previous one can only match a subset of
+    // what already matched, so only the current matches need checking.
+    const bool narrowing = !m_filterText.isEmpty()
+            && filter.contains(m_filterText, Qt::CaseInsensitive);
+    m_filterText = filter;
+
+    if (!isLoading()) {
+        applyFilter(narrowing);
+    }
+}
+
+void InstalledFilesModel::clear()
+{
+    // Results of a load still in flight belong to the previous package
+    const bool wasLoading = isLoading();
+    ++m_generation;
+    m_packageKey.clear();
+
+    beginResetModel();
+    m_files.clear();
+    m_matches.clear();
+    m_fetched = 0;
+    endResetModel();
+
+    if (wasLoading) {
+        emit loadingChanged(false);
+    }
+    emit countsChanged();
+}
+
+bool InstalledFilesModel::isLoading() const
+{
+    return m_loadGeneration == m_generation && m_watcher->isRunning();
+}
+
+int InstalledFilesModel::totalCount() const
+{
+    return m_files.size();
+}
+
+int InstalledFilesModel::matchCount() const
+{
+    return m_matches.size();
+}
+
+void InstalledFilesModel::applyFilter(bool narrowing)
+{
+    QVector<int> matches;
+    if (narrowing) {
+        matches.reserve(m_matches.size());
+        for (int i : qAsConst(m_matches)) {
+            if (m_files.at(i).contains(m_filterText, Qt::CaseInsensitive)) {
+                matches.append(i);
+            }
+        }
+    } else {
+        matches.reserve(m_files.size());
+        for (int i = 0; i < m_files.size(); ++i) {
+            if (m_filterText.isEmpty()
+                    || m_files.at(i).contains(m_filterText, Qt::CaseInsensitive)) {
+                matches.append(i);
+            }
+        }
+    }
+
+    beginResetModel();
+    m_matches = matches;
+    m_fetched = qMin(s_fetchBatchSize, m_matches.size());
+    endResetModel();
+
+    emit countsChanged();
+}
+
+void InstalledFilesModel::loadFinished()
+{
+    if (m_loadGeneration != m_generation) {
+        return;
+    }
+
+    m_files = m_watcher->result();
+    applyFilter(false);
+
+    emit loadingChanged(false);
+}
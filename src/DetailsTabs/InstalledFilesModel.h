@@ -0,0 +1,89 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef INSTALLEDFILESMODEL_H
+#define INSTALLEDFILESMODEL_H
+
+#include <QAbstractListModel>
+#include <QFutureWatcher>
+#include <QStringList>
+#include <QVector>
+
+namespace QApt {
+    class Package;
+}
+
+/**
+ * List model of the files installed by a package.
+ *
+ * The dpkg file list is read and sorted on a worker thread, and rows are
+ * handed to the view in batches through fetchMore(), so even packages with
+ * hundreds of thousands of files open instantly. Filtering narrows the
+ * previous result when the filter text is extended.
+ */
+class InstalledFilesModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    explicit InstalledFilesModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    void setPackage(QApt::Package *package);
+    /// Identifies the installed files of @p package: name, architecture and installed version
+    static QString packageKey(QApt::Package *package);
+    /// The key of the package listed, empty if none is
+    QString packageKey() const;
+    /// Reads the sorted dpkg file list of an installed package; safe on any thread
+    static QStringList readFileList(const QString &name, const QString &arch);
+    void setFilterText(const QString &text);
+    void clear();
+
+    bool isLoading() const;
+    int totalCount() const;
+    int matchCount() const;
+
+private:
+    QFutureWatcher<QStringList> *m_watcher;
+    int m_generation;
+    int m_loadGeneration;
+
+    QString m_packageKey;
+    QStringList m_files;
+    // Indexes into m_files that match the current filter
+    QVector<int> m_matches;
+    // Number of matches exposed to the view so far
+    int m_fetched;
+    QString m_filterText;
+
+    void applyFilter(bool narrowing);
+
+private Q_SLOTS:
+    void loadFinished();
+
+Q_SIGNALS:
+    void loadingChanged(bool loading);
+    void countsChanged();
+};
+
+#endif // INSTALLEDFILESMODEL_H
@@ -21,7 +21,10 @@
 #include "InstalledFilesTab.h"
 
 // Qt includes
-#include <QTextBrowser>
+#include <QFontDatabase>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListView>
 
 // KDE includes
 #include <KLocalizedString>
@@ -29,13 +32,32 @@
 // QApt includes
 #include <QApt/Package>
 
+// Own includes
+#include "InstalledFilesModel.h"
+
 InstalledFilesTab::InstalledFilesTab(QWidget *parent)
     : DetailsTab(parent)
 {
     m_name = i18nc("@title:tab", "Installed Files");
-    m_filesBrowser = new QTextBrowser(this);
+    m_filesModel = new InstalledFilesModel(this);
+
+    m_filterEdit = new QLineEdit(this);
+    m_filterEdit->setPlaceholderText(i18nc("@label Line edit click message", "Filter files"));
+    m_filterEdit->setClearButtonEnabled(true);
+    connect(m_filterEdit, &QLineEdit::textChanged, m_filesModel, &InstalledFilesModel::setFilterText);
+
+    m_filesView = new QListView(this);
+    m_filesView->setUniformItemSizes(true);
+    m_filesView->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    m_filesView->setModel(m_filesModel);
+
+    m_statusLabel = new QLabel(this);
+    connect(m_filesModel, &InstalledFilesModel::loadingChanged, this, &InstalledFilesTab::updateStatus);
+    connect(m_filesModel, &InstalledFilesModel::countsChanged, this, &InstalledFilesTab::updateStatus);
 
-    m_layout->addWidget(m_filesBrowser);
+    m_layout->addWidget(m_filterEdit);
+    m_layout->addWidget(m_filesView);
+    m_layout->addWidget(m_statusLabel);
 }
 
 bool InstalledFilesTab::shouldShow() const
@@ -55,16 +77,24 @@ void InstalledFilesTab::refresh()
 
 void InstalledFilesTab::populateFilesList()
 {
-    m_filesBrowser->clear();
-    QStringList filesList = m_package->installedFilesList();
-    qSort(filesList);
-    QString filesString;
+    m_filesModel->setPackage(m_package);
+}
 
-    foreach(const QString &file, filesList) {
-        filesString.append(file + '\n');
+void InstalledFilesTab::updateStatus()
+{
+    if (m_filesModel->isLoading()) {
+        m_statusLabel->setText(i18nc("@info:status", "Loading file list..."));
+    } else if (m_filesModel->totalCount() == 0) {
+        // Loaded, but dpkg lists nothing or its list is missing
+        m_statusLabel->setText(m_filesModel->packageKey().isEmpty() ? QString()
+                                                                    : i18nc("@info:status", "No files"));
+    } else if (m_filesModel->matchCount() == m_filesModel->totalCount()) {
+        m_statusLabel->setText(i18ncp("@info:status", "%1 file", "%1 files",
+                                      m_filesModel->totalCount()));
+    } else {
+        m_statusLabel->setText(i18nc("@info:status", "%1 of %2 files",
+                                     m_filesModel->matchCount(), m_filesModel->totalCount()));
     }
-
-    m_filesBrowser->setPlainText(filesString);
 }
 
 
@@ -23,7 +23,11 @@
 
 #include "DetailsTab.h"
 
-class QTextBrowser;
+class QLabel;
+class QLineEdit;
+class QListView;
+
+class InstalledFilesModel;
 
 class InstalledFilesTab : public DetailsTab
 {
@@ -34,7 +38,10 @@ public:
     bool shouldShow() const;
 
 private:
-    QTextBrowser *m_filesBrowser;
+    QLineEdit *m_filterEdit;
+    QListView *m_filesView;
+    QLabel *m_statusLabel;
+    InstalledFilesModel *m_filesModel;
 
 public Q_SLOTS:
     void setPackage(QApt::Package *package);
@@ -42,6 +49,7 @@ public Q_SLOTS:
 
 private Q_SLOTS:
     void populateFilesList();
+    void updateStatus();
 };
 
 #endif
@@ -23,6 +23,8 @@
 // Qt includes
 #include <QGridLayout>
 #include <QGroupBox>
+#include <QLocale>
+#include <QStringBuilder>
 #include <QtWidgets/QLabel>
 #include <QScrollArea>
 
@@ -35,7 +37,9 @@
 #include <QApt/Package>
 
 // Own includes
+#include "muonapt/HistoryView/HistoryModel.h"
 #include "muonapt/MuonStrings.h"
+#include "muonapt/QAptActions.h"
 
 TechnicalDetailsTab::TechnicalDetailsTab(QWidget *parent)
     : DetailsTab(parent)
@@ -123,6 +127,14 @@ TechnicalDetailsTab::TechnicalDetailsTab(QWidget *parent)
     m_installedSize->setTextInteractionFlags(Qt::TextSelectableByMouse);
     installedGridLayout->addWidget(installedSizeLabel, 1, 0, Qt::AlignRight);
     installedGridLayout->addWidget(m_installedSize, 1, 1, Qt::AlignLeft);
+    // installedVersionBox, row 2
+    m_installDateLabel = new QLabel(m_installedVersionBox);
+    m_installDateLabel->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    m_installDateLabel->setText(i18nc("@label Label preceding the date a package was installed", "Installed On:"));
+    m_installDate = new QLabel(m_installedVersionBox);
+    m_installDate->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    installedGridLayout->addWidget(m_installDateLabel, 2, 0, Qt::AlignRight);
+    installedGridLayout->addWidget(m_installDate, 2, 1, Qt::AlignLeft);
     installedGridLayout->setRowStretch(3, 1);
     installedGridLayout->setColumnStretch(1, 1);
 
@@ -174,6 +186,39 @@ TechnicalDetailsTab::TechnicalDetailsTab(QWidget *parent)
     QWidget *mainWidget = new QWidget;
     mainWidget->setLayout(mainLayout);
     scrollArea->setWidget(mainWidget);
+
+    // Only read the history once something else loaded it, and follow APT's
+    // log from then on so the date shows up right after an install
+    if (HistoryModel *history = QAptActions::self()->loadedHistoryModel()) {
+        watchHistory(history);
+    } else {
+        connect(QAptActions::self(), &QAptActions::historyModelLoaded, this, &TechnicalDetailsTab::watchHistory);
+    }
+}
+
+void TechnicalDetailsTab::watchHistory(HistoryModel *history)
+{
+    connect(history, &QAbstractItemModel::rowsInserted, this, &TechnicalDetailsTab::updateInstallDate);
+    updateInstallDate();
+}
+
+void TechnicalDetailsTab::updateInstallDate()
+{
+    if (!m_package || !m_package->isInstalled()) {
+        return;
+    }
+
+    QDateTime installTime;
+    if (HistoryModel *history = QAptActions::self()->loadedHistoryModel()) {
+        installTime = history->store().installTime(m_package->name() % QLatin1Char(':') % m_package->architecture());
+        if (!installTime.isValid()) {
+            // Older logs name packages without their architecture
+            installTime = history->store().installTime(m_package->name());
+        }
+    }
+    m_installDateLabel->setVisible(installTime.isValid());
+    m_installDate->setVisible(installTime.isValid());
+    m_installDate->setText(QLocale().toString(installTime, QLocale::ShortFormat));
 }
 
 void TechnicalDetailsTab::refresh()
@@ -192,6 +237,7 @@ void TechnicalDetailsTab::refresh()
         m_installedVersionBox->show();
         m_installedVersion->setText(m_package->installedVersion());
         m_installedSize->setText(KFormat().formatByteSize(m_package->currentInstalledSize()));
+        updateInstallDate();
     } else {
         m_installedVersionBox->hide();
     }
@@ -26,6 +26,8 @@
 class QGroupBox;
 class QLabel;
 
+class HistoryModel;
+
 class TechnicalDetailsTab : public DetailsTab
 {
     Q_OBJECT
@@ -44,12 +46,18 @@ private:
 
     QLabel *m_installedVersion;
     QLabel *m_installedSize;
+    QLabel *m_installDateLabel;
+    QLabel *m_installDate;
     QLabel *m_currentVersion;
     QLabel *m_currentSize;
     QLabel *m_downloadSize;
 
 public Q_SLOTS:
     void refresh();
+
+private Q_SLOTS:
+    void watchHistory(HistoryModel *history);
+    void updateInstallDate();
 };
 
 #endif
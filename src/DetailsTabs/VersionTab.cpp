@@ -33,6 +33,10 @@
 // QApt includes
 #include <QApt/Package>
 
+// Own includes
+#include "muonapt/MarkingJournal.h"
+#include "muonapt/QAptActions.h"
+
 VersionTab::VersionTab(QWidget *parent)
     : DetailsTab(parent)
 {
@@ -117,7 +121,10 @@ void VersionTab::populateVersions()
 
 void VersionTab::forceVersion()
 {
-    m_package->setVersion(m_versions.at(m_versionsView->currentIndex().row()));
+    // Through the journal, so undoing it brings the previous candidate back
+    MarkingJournal *journal = QAptActions::self()->journal();
+    journal->checkpoint();
+    journal->setVersion(m_package, m_versions.at(m_versionsView->currentIndex().row()));
     m_package->setInstall();
 }
 
@@ -20,16 +20,26 @@
 
 #include "DownloadModel.h"
 
+#include <QtCore/QTimer>
+
 #include <KLocalizedString>
 
 DownloadModel::DownloadModel(QObject *parent)
 : QAbstractListModel(parent)
+, m_firstDirtyRow(-1)
+, m_lastDirtyRow(-1)
 {
+    // Progress arrives far more often than it can usefully be painted, so
+    // changes are collected and reported at most once per frame
+    m_flushTimer = new QTimer(this);
+    m_flushTimer->setSingleShot(true);
+    m_flushTimer->setInterval(16);
+    connect(m_flushTimer, SIGNAL(timeout()), this, SLOT(flushChanges()));
 }
 
 QVariant DownloadModel::data(const QModelIndex& index, int role) const
 {
-    if (!index.isValid() || index.row() > m_itemList.size() || index.row() < 0) {
+    if (!index.isValid() || index.row() >= m_itemList.size() || index.row() < 0) {
         return QVariant();
     }
 
@@ -71,33 +81,53 @@ QVariant DownloadModel::headerData(int section, Qt::Orientation orientation, int
 
 void DownloadModel::updateDetails(const QApt::DownloadProgress &details)
 {
-    bool newPackage = true;
-    for (int i = 0; i < m_itemList.size(); ++i) {
-        // URI should be unique
-        if (m_itemList.at(i).uri() != details.uri()) {
-            continue;
-        }
-
-        newPackage = false;
-        m_itemList[i] = details;
-        // If we get more than 10 columns we'll have to bump this.
-        // ... but that's really not likely...
-        emit dataChanged(index(i, 0), index(i, 9));
-        break;
-    }
-
-    if (newPackage) {
-        beginInsertRows(QModelIndex(), m_itemList.count(), m_itemList.count());
+    const auto it = m_rowForUri.constFind(details.uri());
+    if (it == m_rowForUri.constEnd()) {
+        const int row = m_itemList.count();
+        beginInsertRows(QModelIndex(), row, row);
         m_itemList.append(details);
+        m_rowForUri.insert(details.uri(), row);
         endInsertRows();
+        return;
     }
 
-    return;
+    const int row = it.value();
+    m_itemList[row] = details;
+
+    if (m_firstDirtyRow == -1) {
+        m_firstDirtyRow = row;
+        m_lastDirtyRow = row;
+    } else {
+        m_firstDirtyRow = qMin(m_firstDirtyRow, row);
+        m_lastDirtyRow = qMax(m_lastDirtyRow, row);
+    }
+
+    if (!m_flushTimer->isActive()) {
+        m_flushTimer->start();
+    }
+}
+
+void DownloadModel::flushChanges()
+{
+    if (m_firstDirtyRow == -1) {
+        return;
+    }
+
+    emit dataChanged(index(m_firstDirtyRow, 0), index(m_lastDirtyRow, columnCount() - 1));
+    m_firstDirtyRow = -1;
+    m_lastDirtyRow = -1;
 }
 
 void DownloadModel::clear()
 {
+    m_flushTimer->stop();
+    m_firstDirtyRow = -1;
+    m_lastDirtyRow = -1;
+
+    beginResetModel();
     m_itemList.clear();
+    m_rowForUri.clear();
+    endResetModel();
 }
 
 int DownloadModel::rowCount(const QModelIndex& /*parent*/) const
@@ -21,11 +21,14 @@
 #ifndef DOWNLOADMODEL_H
 #define DOWNLOADMODEL_H
 
+#include <QtCore/QHash>
 #include <QtCore/QVector>
 #include <QModelIndex>
 
 #include <QApt/DownloadProgress>
 
+class QTimer;
+
 class DownloadModel : public QAbstractListModel
 {
     Q_OBJECT
@@ -49,11 +52,18 @@ public Q_SLOTS:
     void updateDetails(const QApt::DownloadProgress &details);
     void clear();
 
-Q_SIGNALS:
-    void dataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight);
+private Q_SLOTS:
+    void flushChanges();
 
 private:
     QVector<QApt::DownloadProgress> m_itemList;
+    // URI should be unique, so it identifies the row
+    QHash<QString, int> m_rowForUri;
+
+    // Rows changed since the last flush, reported as one range
+    int m_firstDirtyRow;
+    int m_lastDirtyRow;
+    QTimer *m_flushTimer;
 };
 
 #endif // DOWNLOADMODEL_H
@@ -0,0 +1,288 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "DownloadTelemetry.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QRegularExpression>
+#include <QtCore/QSaveFile>
+#include <QtCore/QStandardPaths>
+#include <QtCore/QUrl>
+
+#include <algorithm>
+
+// Throughput is averaged over this much recent history
+static const qint64 s_windowMs = 5000;
+// Logs kept in the telemetry directory, older ones are removed
+static const int s_maximumLogCount = 50;
+
+DownloadTelemetry::DownloadTelemetry(QObject *parent)
+    : QObject(parent)
+    , m_lastDataMs(0)
+{
+}
+
+void DownloadTelemetry::start(const QString &label)
+{
+    m_label = label;
+    m_startTime = QDateTime::currentDateTimeUtc();
+    m_clock.start();
+    m_lastDataMs = 0;
+    m_items.clear();
+    m_hosts.clear();
+}
+
+void DownloadTelemetry::updateDetails(const QApt::DownloadProgress &details)
+{
+    if (!m_clock.isValid()) {
+        start(QString());
+    }
+
+    const qint64 now = elapsedMs();
+    auto it = m_items.find(details.uri());
+    if (it == m_items.end()) {
+        ItemState item;
+        item.host = QUrl(details.uri()).host();
+        if (item.host.isEmpty()) {
+            item.host = QUrl(details.uri()).scheme();
+        }
+        item.startedMs = now;
+        item.firstByteMs = -1;
+        item.partialSize = 0;
+        item.fileSize = 0;
+        item.retries = 0;
+        item.done = false;
+        item.failed = false;
+        it = m_items.insert(details.uri(), item);
+    }
+
+    ItemState &item = it.value();
+    item.fileSize = details.fileSize();
+
+    const quint64 partialSize = details.partialSize();
+    if (partialSize < item.partialSize || (item.failed && details.status() == QApt::FetchingState)) {
+        // Started over, either after an error or on another mirror
+        ++item.retries;
+        item.failed = false;
+        item.partialSize = 0;
+    }
+
+    if (partialSize > item.partialSize) {
+        if (item.firstByteMs == -1) {
+            item.firstByteMs = now - item.startedMs;
+        }
+        addSample(m_hosts[item.host], qint64(partialSize - item.partialSize), now);
+        item.partialSize = partialSize;
+    }
+
+    switch (details.status()) {
+    case QApt::DoneState:
+    case QApt::HitState:
+        item.done = true;
+        item.partialSize = qMax(item.partialSize, item.fileSize);
+        break;
+    case QApt::ErrorState:
+        item.failed = true;
+        break;
+    default:
+        break;
+    }
+}
+
+qint64 DownloadTelemetry::elapsedMs() const
+{
+    return m_clock.elapsed();
+}
+
+void DownloadTelemetry::addSample(HostState &host, qint64 bytes, qint64 now)
+{
+    host.samples.enqueue({ now, bytes });
+    host.totalBytes += bytes;
+    m_lastDataMs = now;
+    while (host.samples.head().timeMs < now - s_windowMs) {
+        host.samples.dequeue();
+    }
+}
+
+qint64 DownloadTelemetry::rateOf(const HostState &host) const
+{
+    // Samples are only dropped when data arrives; a stalled host must not
+    // keep showing its last rate
+    const qint64 now = elapsedMs();
+    qint64 bytes = 0;
+    for (const Sample &sample : host.samples) {
+        if (sample.timeMs >= now - s_windowMs) {
+            bytes += sample.bytes;
+        }
+    }
+
+    const qint64 span = qMin(s_windowMs, qMax<qint64>(now, 1));
+    return bytes * 1000 / span;
+}
+
+QVector<DownloadTelemetry::HostStats> DownloadTelemetry::hostStats() const
+{
+    QHash<QString, HostStats> stats;
+    QHash<QString, qint64> firstByteTotals;
+    QHash<QString, int> firstByteCounts;
+
+    for (const ItemState &item : m_items) {
+        auto it = stats.find(item.host);
+        if (it == stats.end()) {
+            HostStats host;
+            host.host = item.host;
+            host.bytesPerSecond = 0;
+            host.totalBytes = 0;
+            host.items = 0;
+            host.finishedItems = 0;
+            host.retries = 0;
+            host.errors = 0;
+            host.meanFirstByteMs = -1;
+            it = stats.insert(item.host, host);
+        }
+
+        ++it->items;
+        it->finishedItems += item.done ? 1 : 0;
+        it->retries += item.retries;
+        it->errors += item.failed ? 1 : 0;
+        if (item.firstByteMs != -1) {
+            firstByteTotals[item.host] += item.firstByteMs;
+            ++firstByteCounts[item.host];
+        }
+    }
+
+    QVector<HostStats> result;
+    for (HostStats &host : stats) {
+        const auto state = m_hosts.constFind(host.host);
+        if (state != m_hosts.constEnd()) {
+            host.bytesPerSecond = rateOf(*state);
+            host.totalBytes = state->totalBytes;
+        }
+        const int count = firstByteCounts.value(host.host);
+        if (count > 0) {
+            host.meanFirstByteMs = firstByteTotals.value(host.host) / count;
+        }
+        result.append(host);
+    }
+
+    std::sort(result.begin(), result.end(), [](const HostStats &a, const HostStats &b) {
+        return a.totalBytes > b.totalBytes;
+    });
+    return result;
+}
+
+qint64 DownloadTelemetry::bytesPerSecond() const
+{
+    qint64 rate = 0;
+    for (const HostState &host : m_hosts) {
+        rate += rateOf(host);
+    }
+    return rate;
+}
+
+qint64 DownloadTelemetry::eta() const
+{
+    quint64 remaining = 0;
+    for (const ItemState &item : m_items) {
+        if (!item.done && item.fileSize > item.partialSize) {
+            remaining += item.fileSize - item.partialSize;
+        }
+    }
+
+    if (remaining == 0) {
+        return 0;
+    }
+    const qint64 rate = bytesPerSecond();
+    return rate > 0 ? qint64(remaining) / rate : -1;
+}
+
+QString DownloadTelemetry::writeLog(const QString &outcome) const
+{
+    if (m_items.isEmpty()) {
+        return QString();
+    }
+
+    // Installing follows in the same transaction; only the download counts
+    const qint64 elapsed = qMax<qint64>(m_lastDataMs, 1);
+
+    QJsonArray hosts;
+    for (const HostStats &host : hostStats()) {
+        QJsonObject object;
+        object.insert(QStringLiteral("host"), host.host);
+        object.insert(QStringLiteral("bytes"), host.totalBytes);
+        object.insert(QStringLiteral("averageBytesPerSecond"), host.totalBytes * 1000 / elapsed);
+        object.insert(QStringLiteral("items"), host.items);
+        object.insert(QStringLiteral("finishedItems"), host.finishedItems);
+        object.insert(QStringLiteral("retries"), host.retries);
+        object.insert(QStringLiteral("errors"), host.errors);
+        object.insert(QStringLiteral("meanFirstByteMs"), host.meanFirstByteMs);
+        hosts.append(object);
+    }
+
+    QJsonArray items;
+    for (auto it = m_items.constBegin(); it != m_items.constEnd(); ++it) {
+        QJsonObject object;
+        object.insert(QStringLiteral("uri"), it.key());
+        object.insert(QStringLiteral("host"), it->host);
+        object.insert(QStringLiteral("size"), qint64(it->fileSize));
+        object.insert(QStringLiteral("firstByteMs"), it->firstByteMs);
+        object.insert(QStringLiteral("retries"), it->retries);
+        object.insert(QStringLiteral("done"), it->done);
+        items.append(object);
+    }
+
+    QJsonObject root;
+    root.insert(QStringLiteral("transaction"), m_label);
+    root.insert(QStringLiteral("started"), m_startTime.toString(Qt::ISODate));
+    root.insert(QStringLiteral("downloadMs"), m_lastDataMs);
+    root.insert(QStringLiteral("outcome"), outcome);
+    root.insert(QStringLiteral("hosts"), hosts);
+    root.insert(QStringLiteral("items"), items);
+
+    const QString dirPath = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)
+            + QLatin1String("/download-telemetry");
+    QDir().mkpath(dirPath);
+    // Transactions can start within the same second; the id tells them apart
+    QString id = m_label.section(QLatin1Char('/'), -1);
+    id.remove(QRegularExpression(QStringLiteral("[^A-Za-z0-9_-]")));
+    QString path = dirPath + QLatin1Char('/') + m_startTime.toString(QStringLiteral("yyyyMMdd-HHmmss"));
+    if (!id.isEmpty()) {
+        path += QLatin1Char('-') + id;
+    }
+    path += QLatin1String(".json");
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return QString();
+    }
+    file.write(QJsonDocument(root).toJson());
+    if (!file.commit()) {
+        return QString();
+    }
+
+    const QFileInfoList logs = QDir(dirPath).entryInfoList({ QStringLiteral("*.json") }, QDir::Files, QDir::Time);
+    for (int i = s_maximumLogCount; i < logs.size(); ++i) {
+        QFile::remove(logs.at(i).absoluteFilePath());
+    }
+    return path;
+}
@@ -0,0 +1,112 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef DOWNLOADTELEMETRY_H
+#define DOWNLOADTELEMETRY_H
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QObject>
+#include <QQueue>
+#include <QVector>
+
+#include <QApt/DownloadProgress>
+
+/**
+ * Download statistics of one transaction, per source host: throughput over
+ * a sliding window, latency to the first byte of each item and retries,
+ * plus an estimate of the time left.
+ *
+ * It is fed the same DownloadProgress updates as the DownloadModel and can
+ * write what it collected to a JSON log, so mirrors can be compared.
+ */
+class DownloadTelemetry : public QObject
+{
+    Q_OBJECT
+public:
+    struct HostStats {
+        QString host;
+        qint64 bytesPerSecond;
+        qint64 totalBytes;
+        int items;
+        int finishedItems;
+        int retries;
+        int errors;
+        // Mean over the items that received data, -1 if none did yet
+        qint64 meanFirstByteMs;
+    };
+
+    explicit DownloadTelemetry(QObject *parent = nullptr);
+
+    void start(const QString &label);
+    void updateDetails(const QApt::DownloadProgress &details);
+
+    QVector<HostStats> hostStats() const;
+    qint64 bytesPerSecond() const;
+    /// Seconds until all known items are fetched at the current rate, -1 if unknown
+    qint64 eta() const;
+
+    /**
+     * Writes the collected statistics to a JSON file in the user's data
+     * directory and returns its path, or an empty string on failure.
+     * Only the most recent logs are kept.
+     */
+    QString writeLog(const QString &outcome) const;
+
+protected:
+    /// Milliseconds since start(); tests drive the clock through it
+    virtual qint64 elapsedMs() const;
+
+private:
+    struct ItemState {
+        QString host;
+        qint64 startedMs;
+        qint64 firstByteMs;
+        quint64 partialSize;
+        quint64 fileSize;
+        int retries;
+        bool done;
+        bool failed;
+    };
+
+    struct Sample {
+        qint64 timeMs;
+        qint64 bytes;
+    };
+
+    struct HostState {
+        QQueue<Sample> samples;
+        qint64 totalBytes;
+    };
+
+    QString m_label;
+    QDateTime m_startTime;
+    QElapsedTimer m_clock;
+    // When the last data arrived, which ends the download phase
+    qint64 m_lastDataMs;
+    QHash<QString, ItemState> m_items;
+    QHash<QString, HostState> m_hosts;
+
+    void addSample(HostState &host, qint64 bytes, qint64 now);
+    qint64 rateOf(const HostState &host) const;
+};
+
+#endif // DOWNLOADTELEMETRY_H
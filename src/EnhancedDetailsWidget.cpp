@@ -34,6 +34,11 @@
 #include <QPainter>
 #include <QPalette>
 #include <QDebug>
+#include <QFontDatabase>
+#include <QLineEdit>
+#include <QListView>
+#include <QTimer>
+#include <QtConcurrent>
 
 #include "PackageModel/FlatpakManager.h"
 
@@ -44,12 +49,18 @@
 
 // QApt includes
 #include <QApt/Backend>
+#include <QApt/Config>
+#include <QApt/DependencyInfo>
 #include <QApt/Package>
 
 // Own includes
+#include "DetailsTabs/InstalledFilesModel.h"
+#include "muonapt/DependencyGraph.h"
 #include "PackageModel/PackageIconExtractor.h"
 #include "PackageModel/LocalPackageManager.h"
 #include "muonapt/MuonStrings.h"
+#include "ScreenshotLoader.h"
+#include "TransactionQueue.h"
 
 EnhancedDetailsWidget::EnhancedDetailsWidget(QWidget *parent)
     : QWidget(parent)
@@ -61,9 +72,35 @@ EnhancedDetailsWidget::EnhancedDetailsWidget(QWidget *parent)
     , m_headerGradientStart(QPalette().color(QPalette::Window))
     , m_headerGradientEnd(QPalette().color(QPalette::Window).darker(110))
     , m_tabTransitionDuration(200)
+    , m_footprintGeneration(0)
+    , m_detailsGeneration(0)
+    , m_dependenciesRequest(0)
 {
     AppStreamHelper::instance()->init();
+    m_settleTimer = new QTimer(this);
+    m_settleTimer->setSingleShot(true);
+    m_settleTimer->setInterval(150);
+    connect(m_settleTimer, &QTimer::timeout, this, &EnhancedDetailsWidget::loadDetails);
+
+    // Thumbnails match the fixed screenshot label in the header
+    m_screenshotLoader = new ScreenshotLoader(QSize(200, 112) * devicePixelRatioF(), this);
     setupUI();
+
+    connect(m_screenshotLoader, &ScreenshotLoader::loaded,
+            this, &EnhancedDetailsWidget::screenshotLoaded);
+    connect(m_screenshotLoader, &ScreenshotLoader::failed,
+            m_screenshotLabel, &QLabel::hide);
+
+    // AppStream metadata loads in the background; fill it in once it is there
+    connect(AppStreamHelper::instance(), &AppStreamHelper::ready,
+            this, &EnhancedDetailsWidget::updateAppStreamData);
+
+    m_footprintWatcher = new QFutureWatcher<DependencyGraphData::Closure>(this);
+    connect(m_footprintWatcher, &QFutureWatcher<DependencyGraphData::Closure>::finished,
+            this, &EnhancedDetailsWidget::footprintFinished);
+    // The footprint needs the dependency graph, which is built in the background
+    connect(DependencyGraph::instance(), &DependencyGraph::ready,
+            this, &EnhancedDetailsWidget::dependencyGraphReady);
     hide(); // Hide until a package is selected
 }
 
@@ -132,7 +169,7 @@ void EnhancedDetailsWidget::setupHeader()
     // Screenshot preview (initially hidden)
     m_screenshotLabel = new QLabel(m_headerWidget);
     m_screenshotLabel->setFixedSize(200, 112); // 16:9 aspect ratio
-    m_screenshotLabel->setScaledContents(true);
+    m_screenshotLabel->setAlignment(Qt::AlignCenter);
     m_screenshotLabel->setStyleSheet("border: 1px solid palette(mid); border-radius: 4px; background: black;");
     m_screenshotLabel->hide();
     
@@ -258,19 +295,39 @@ void EnhancedDetailsWidget::createFilesTab()
     auto *layout = new QVBoxLayout(m_filesTab);
     layout->setContentsMargins(20, 20, 20, 20);
     
-    m_filesBrowser = new QTextBrowser(m_filesTab);
-    m_filesBrowser->setStyleSheet(R"(
-        QTextBrowser {
+    m_filesModel = new InstalledFilesModel(this);
+
+    m_filesFilterEdit = new QLineEdit(m_filesTab);
+    m_filesFilterEdit->setPlaceholderText(i18nc("@label Line edit click message", "Filter files"));
+    m_filesFilterEdit->setClearButtonEnabled(true);
+    connect(m_filesFilterEdit, &QLineEdit::textChanged,
+            m_filesModel, &InstalledFilesModel::setFilterText);
+
+    // The file list of big packages runs to six figures, so keep it in a
+    // lazily populated view rather than one big text document.
+    m_filesView = new QListView(m_filesTab);
+    m_filesView->setUniformItemSizes(true);
+    m_filesView->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    m_filesView->setStyleSheet(R"(
+        QListView {
             border: 1px solid palette(mid);
             border-radius: 8px;
             padding: 10px;
             background-color: palette(base);
-            font-family: monospace;
-            font-size: 9pt;
         }
     )");
-    
-    layout->addWidget(m_filesBrowser);
+    m_filesView->setModel(m_filesModel);
+
+    m_filesStatusLabel = new QLabel(m_filesTab);
+    m_filesStatusLabel->setStyleSheet("QLabel { color: palette(mid); font-size: 9pt; }");
+    connect(m_filesModel, &InstalledFilesModel::loadingChanged,
+            this, &EnhancedDetailsWidget::updateFilesStatus);
+    connect(m_filesModel, &InstalledFilesModel::countsChanged,
+            this, &EnhancedDetailsWidget::updateFilesStatus);
+
+    layout->addWidget(m_filesFilterEdit);
+    layout->addWidget(m_filesView);
+    layout->addWidget(m_filesStatusLabel);
     
     m_tabWidget->addTab(m_filesTab, i18nc("@title:tab", "Files"));
 }
@@ -293,6 +350,10 @@ void EnhancedDetailsWidget::createDependenciesTab()
         }
     )");
     
+    m_footprintLabel = new QLabel(m_dependenciesTab);
+    m_footprintLabel->setWordWrap(true);
+
+    layout->addWidget(m_footprintLabel);
     layout->addWidget(m_dependenciesBrowser);
     
     m_tabWidget->addTab(m_dependenciesTab, i18nc("@title:tab", "Dependencies"));
@@ -443,24 +504,17 @@ void EnhancedDetailsWidget::setPackage(QApt::Package *package)
         return;
     }
     
-    // Update header information
-    m_iconLabel->setPixmap(PackageIconExtractor::instance()->getPackageIcon(package).pixmap(64, 64));
+    // Update header information from what is already at hand; the icon
+    // is extracted later if it is not cached yet
+    QIcon icon = PackageIconExtractor::instance()->cachedPackageIcon(package->name());
+    if (icon.isNull()) {
+        icon = QIcon::fromTheme("package-x-generic");
+    }
+    m_iconLabel->setPixmap(icon.pixmap(64, 64));
     m_nameLabel->setText(package->name());
     m_descriptionLabel->setText(package->shortDescription());
     m_versionLabel->setText(i18nc("@label", "Version: %1", package->version()));
     
-    // AppStream Integration
-    QString screenshotUrl = AppStreamHelper::instance()->getScreenshotUrl(package->name());
-    if (!screenshotUrl.isEmpty()) {
-        // In a real implementation, we would fetch this asynchronously via QNetworkAccessManager
-        // For now, we'll just log it or set a placeholder if we had a local cache
-        // m_screenshotLabel->show();
-        // Network fetching logic would go here
-        qDebug() << "Found screenshot URL for" << package->name() << ":" << screenshotUrl;
-    } else {
-        m_screenshotLabel->hide();
-    }
-    
     // Check if it's a local package
     if (LocalPackageManager::instance()->isLocalInstallPackage(package->name())) {
         m_isLocal = true;
@@ -478,12 +532,82 @@ void EnhancedDetailsWidget::setPackage(QApt::Package *package)
     m_updateButton->setVisible(isInstalled && isUpgradeable);
     m_removeButton->setVisible(isInstalled);
     
-    // Update tab content
-    refreshCurrentTab();
+    // Everything else waits until the selection settles, so holding an
+    // arrow key in the list does not load details for every row passed.
+    // Marking changes reselect the same package; its file list stays.
+    cancelDetails(package->isInstalled()
+                  && InstalledFilesModel::packageKey(package) == m_filesModel->packageKey());
+    m_settleTimer->start();
     
     show();
 }
 
+void EnhancedDetailsWidget::cancelDetails(bool keepFiles)
+{
+    m_settleTimer->stop();
+
+    // Drop whatever was shown or is still loading for the previous selection
+    ++m_detailsGeneration;
+    ++m_dependenciesRequest;
+    m_screenshotLoader->cancel();
+    m_screenshotLabel->hide();
+    m_descriptionBrowser->clear();
+    if (!keepFiles) {
+        m_filesModel->clear();
+        m_filesStatusLabel->clear();
+    }
+    m_dependenciesBrowser->clear();
+    m_footprintLabel->clear();
+    m_versionsBrowser->clear();
+}
+
+void EnhancedDetailsWidget::loadDetails()
+{
+    if (!m_package) {
+        return;
+    }
+
+    loadIcon();
+
+    // AppStream Integration
+    updateAppStreamData();
+
+    // Update tab content
+    refreshCurrentTab();
+}
+
+void EnhancedDetailsWidget::loadIcon()
+{
+    PackageIconExtractor *extractor = PackageIconExtractor::instance();
+    if (!extractor->cachedPackageIcon(m_package->name()).isNull()) {
+        return; // setPackage() already shows it
+    }
+    if (!m_package->isInstalled()) {
+        // Nothing to read, only the section decides
+        m_iconLabel->setPixmap(extractor->packageIcon(m_package, QString()).pixmap(64, 64));
+        return;
+    }
+
+    // Reading the file list and desktop files happens on a worker; only
+    // making the icon out of what it found needs the GUI thread
+    const QString name = m_package->name();
+    const QString arch = m_package->architecture();
+    const quint64 generation = m_detailsGeneration;
+    auto *watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher, generation]() {
+        const QString iconName = watcher->result();
+        watcher->deleteLater();
+
+        if (generation != m_detailsGeneration || !m_package) {
+            return;
+        }
+        m_iconLabel->setPixmap(PackageIconExtractor::instance()->packageIcon(m_package, iconName).pixmap(64, 64));
+    });
+    watcher->setFuture(QtConcurrent::run([name, arch]() {
+        return PackageIconExtractor::desktopIconName(InstalledFilesModel::readFileList(name, arch));
+    }));
+}
+
 void EnhancedDetailsWidget::setVirtualPackage(const VirtualPackage &package)
 {
     m_virtualPackage = package;
@@ -491,6 +615,7 @@ void EnhancedDetailsWidget::setVirtualPackage(const VirtualPackage &package)
     m_isLocal = true;
     m_isFlatpak = false;
     m_package = nullptr;
+    cancelDetails();
     
     // Update header information
     // Use extracted icon if available
@@ -528,6 +653,7 @@ void EnhancedDetailsWidget::setFlatpak(const QString &flatpakId)
     m_isVirtual = false;
     m_isLocal = false;
     m_isFlatpak = true;
+    cancelDetails();
     
     // Update header
     // Try to get icon from AppStream or theme
@@ -539,6 +665,11 @@ void EnhancedDetailsWidget::setFlatpak(const QString &flatpakId)
     }
     
     m_nameLabel->setText(pkg.name);
+    m_footprintLabel->clear();
+    if (!pkg.isInstalled && pkg.downloadSize > 0) {
+        m_footprintLabel->setText(i18nc("@info:status", "Download size: %1",
+                                        KFormat().formatByteSize(pkg.downloadSize)));
+    }
     m_descriptionLabel->setText(pkg.description);
     m_versionLabel->setText(i18nc("@label", "Version: %1 (Flatpak)", pkg.version));
     
@@ -554,11 +685,11 @@ void EnhancedDetailsWidget::setFlatpak(const QString &flatpakId)
     disconnect(m_removeButton, nullptr, nullptr, nullptr);
     
     connect(m_installButton, &QPushButton::clicked, this, [this, pkg]() {
-        FlatpakManager::instance()->installPackage(pkg.id, pkg.remote);
+        TransactionQueue::instance()->enqueueFlatpakInstall(pkg.id, pkg.remote);
     });
     
     connect(m_removeButton, &QPushButton::clicked, this, [this, pkg]() {
-        FlatpakManager::instance()->removePackage(pkg.id);
+        TransactionQueue::instance()->enqueueFlatpakRemove(pkg.id);
     });
     
     refreshCurrentTab();
@@ -579,14 +710,48 @@ void EnhancedDetailsWidget::clear()
     m_versionLabel->clear();
     
     // Clear tab content
-    m_descriptionBrowser->clear();
-    m_filesBrowser->clear();
-    m_dependenciesBrowser->clear();
-    m_versionsBrowser->clear();
+    cancelDetails();
     
     hide();
 }
 
+// Core libraries have thousands of dependants, so the text is put together
+// on a worker; the graph snapshot is safe to read from any thread
+static QString dependenciesText(const QStringList &deps, const DependencyGraphSnapshot &graph, int node,
+                                const QHash<int, QString> &typeNames)
+{
+    QString text;
+    if (!deps.isEmpty()) {
+        text += i18nc("@title", "Dependencies:\n");
+        for (const QString &dep : deps) {
+            text.append("  " + dep + '\n');
+        }
+        text += '\n';
+    }
+
+    QStringList revDeps;
+    if (node != -1) {
+        for (const DependencyGraphData::Dependant &dependant : graph->dependantList(node)) {
+            revDeps.append(i18nc("@item package name (dependency type)", "%1 (%2)",
+                                 graph->nodeName(dependant.node), typeNames.value(dependant.type)));
+        }
+    } else if (!graph) {
+        revDeps.append(i18nc("@info", "Still being calculated..."));
+    }
+
+    if (!revDeps.isEmpty()) {
+        text += i18nc("@title", "Reverse Dependencies:\n");
+        for (const QString &revDep : qAsConst(revDeps)) {
+            text.append("  " + revDep + '\n');
+        }
+    }
+
+    if (text.isEmpty()) {
+        text = i18nc("@info", "No dependencies found");
+    }
+    return text;
+}
+
 void EnhancedDetailsWidget::refreshCurrentTab()
 {
     if (!m_package && !m_isVirtual) {
@@ -605,10 +770,12 @@ void EnhancedDetailsWidget::refreshCurrentTab()
             }
             break;
         case 1: // Files tab
-            m_filesBrowser->setPlainText(i18nc("@info", "File list not available for uninstalled local packages."));
+            m_filesModel->clear();
+            m_filesStatusLabel->setText(i18nc("@info", "File list not available for uninstalled local packages."));
             break;
         case 2: // Dependencies tab
             {
+                m_footprintLabel->clear();
                 QString dependenciesText;
                 QStringList deps = m_virtualPackage.dependencies();
                 
@@ -656,46 +823,38 @@ void EnhancedDetailsWidget::refreshCurrentTab()
         
     case 1: // Files tab
         if (m_package->isInstalled()) {
-            QStringList filesList = m_package->installedFilesList();
-            filesList.sort();
-            QString filesText;
-            
-            foreach(const QString &file, filesList) {
-                filesText.append(file + '\n');
-            }
-            
-            m_filesBrowser->setPlainText(filesText);
+            m_filesModel->setPackage(m_package);
         } else {
-            m_filesBrowser->setPlainText(i18nc("@info", "Package is not installed"));
+            m_filesModel->clear();
+            m_filesStatusLabel->setText(i18nc("@info", "Package is not installed"));
         }
         break;
         
     case 2: // Dependencies tab
         {
-            QString dependenciesText;
-            QStringList deps = m_package->dependencyList(false);
-            QStringList revDeps = m_package->requiredByList();
-            
-            if (!deps.isEmpty()) {
-                dependenciesText += i18nc("@title", "Dependencies:\n");
-                foreach(const QString &dep, deps) {
-                    dependenciesText.append("  " + dep + '\n');
-                }
-                dependenciesText += '\n';
+            const QStringList deps = m_package->dependencyList(false);
+            const DependencyGraphSnapshot graph = DependencyGraph::instance()->snapshot();
+            const int node = graph ? graph->nodeOf(m_package) : -1;
+            QHash<int, QString> typeNames;
+            for (int type : { QApt::PreDepends, QApt::Depends, QApt::Recommends, QApt::Suggests,
+                              QApt::Enhances, QApt::Conflicts, QApt::Breaks, QApt::Replaces }) {
+                typeNames.insert(type, MuonStrings::global()->dependencyTypeName(type));
             }
-            
-            if (!revDeps.isEmpty()) {
-                dependenciesText += i18nc("@title", "Reverse Dependencies:\n");
-                foreach(const QString &revDep, revDeps) {
-                    dependenciesText.append("  " + revDep + '\n');
+
+            const quint64 request = ++m_dependenciesRequest;
+            auto *watcher = new QFutureWatcher<QString>(this);
+            connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher, request]() {
+                const QString text = watcher->result();
+                watcher->deleteLater();
+
+                if (request == m_dependenciesRequest) {
+                    m_dependenciesBrowser->setPlainText(text);
                 }
-            }
-            
-            if (dependenciesText.isEmpty()) {
-                dependenciesText = i18nc("@info", "No dependencies found");
-            }
-            
-            m_dependenciesBrowser->setPlainText(dependenciesText);
+            });
+            watcher->setFuture(QtConcurrent::run([deps, graph, node, typeNames]() {
+                return dependenciesText(deps, graph, node, typeNames);
+            }));
+            updateFootprint();
         }
         break;
         
@@ -721,9 +880,136 @@ void EnhancedDetailsWidget::refreshCurrentTab()
 void EnhancedDetailsWidget::onTabChanged(int index)
 {
     Q_UNUSED(index)
+    // The pending load fills in whichever tab is current
+    if (m_settleTimer->isActive()) {
+        return;
+    }
     refreshCurrentTab();
 }
 
+void EnhancedDetailsWidget::updateFilesStatus()
+{
+    if (m_filesModel->isLoading()) {
+        m_filesStatusLabel->setText(i18nc("@info:status", "Loading file list..."));
+    } else if (m_filesModel->totalCount() == 0) {
+        if (!m_filesModel->packageKey().isEmpty()) {
+            // Loaded, but dpkg lists nothing or its list is missing
+            m_filesStatusLabel->setText(i18nc("@info:status", "No files"));
+        }
+        // Otherwise leave explanations such as "not installed" in place
+    } else if (m_filesModel->matchCount() == m_filesModel->totalCount()) {
+        m_filesStatusLabel->setText(i18ncp("@info:status", "%1 file", "%1 files",
+                                           m_filesModel->totalCount()));
+    } else {
+        m_filesStatusLabel->setText(i18nc("@info:status", "%1 of %2 files",
+                                          m_filesModel->matchCount(), m_filesModel->totalCount()));
+    }
+}
+
+void EnhancedDetailsWidget::updateAppStreamData()
+{
+    if (m_settleTimer->isActive()) {
+        // loadDetails() will get to it
+        return;
+    }
+    if (!m_package || !AppStreamHelper::instance()->isReady()) {
+        m_screenshotLoader->cancel();
+        m_screenshotLabel->hide();
+        return;
+    }
+
+    const QString screenshotUrl = AppStreamHelper::instance()->getScreenshotUrl(m_package->name());
+    if (screenshotUrl.isEmpty()) {
+        m_screenshotLoader->cancel();
+        m_screenshotLabel->hide();
+        return;
+    }
+
+    // Keep the label hidden until the thumbnail is there; a previous
+    // package's screenshot must never show up under this one
+    m_screenshotLabel->hide();
+    m_screenshotLabel->clear();
+    m_screenshotLoader->load(QUrl(screenshotUrl));
+}
+
+void EnhancedDetailsWidget::screenshotLoaded(const QUrl &url, const QImage &thumbnail)
+{
+    Q_UNUSED(url)
+
+    QPixmap pixmap = QPixmap::fromImage(thumbnail);
+    pixmap.setDevicePixelRatio(devicePixelRatioF());
+    m_screenshotLabel->setPixmap(pixmap);
+    m_screenshotLabel->show();
+}
+
+void EnhancedDetailsWidget::dependencyGraphReady()
+{
+    // Reverse dependencies and the footprint both come from the graph
+    if (m_tabWidget->currentIndex() == 2 && !m_settleTimer->isActive()) {
+        refreshCurrentTab();
+    }
+}
+
+void EnhancedDetailsWidget::updateFootprint()
+{
+    if (!m_package || m_isVirtual || m_isFlatpak || m_tabWidget->currentIndex() != 2
+            || m_settleTimer->isActive()) {
+        return;
+    }
+
+    const DependencyGraphSnapshot graph = DependencyGraph::instance()->snapshot();
+    if (!graph) {
+        m_footprintLabel->setText(i18nc("@info:status", "Calculating installation size..."));
+        return;
+    }
+
+    const int node = graph->nodeOf(m_package);
+    if (node == -1) {
+        m_footprintLabel->clear();
+        return;
+    }
+
+    bool withRecommends = true;
+    if (m_backend) {
+        withRecommends = m_backend->config()->readEntry(QStringLiteral("APT::Install-Recommends"), true);
+    }
+
+    m_footprintGeneration = graph->generation;
+    m_footprintLabel->setText(i18nc("@info:status", "Calculating installation size..."));
+    m_footprintWatcher->setFuture(QtConcurrent::run([graph, node, withRecommends]() {
+        return graph->closure(node, withRecommends);
+    }));
+}
+
+void EnhancedDetailsWidget::footprintFinished()
+{
+    const DependencyGraphData::Closure closure = m_footprintWatcher->result();
+
+    // Drop results for a package or cache that is no longer shown
+    const DependencyGraphSnapshot graph = DependencyGraph::instance()->snapshot();
+    if (!m_package || !graph || graph->generation != m_footprintGeneration
+            || graph->nodeOf(m_package) != closure.node) {
+        return;
+    }
+
+    QString text = i18ncp("@info", "Depends on %1 package in total.",
+                          "Depends on %1 packages in total.", closure.dependencyCount);
+    if (closure.newPackageCount > 0) {
+        KFormat format;
+        text += QLatin1Char(' ');
+        text += i18ncp("@info", "Installing it brings in %1 new package: %2 to download, %3 of disk space.",
+                       "Installing it brings in %1 new packages: %2 to download, %3 of disk space.",
+                       closure.newPackageCount,
+                       format.formatByteSize(closure.downloadSize),
+                       format.formatByteSize(closure.installedSize));
+    } else {
+        text += QLatin1Char(' ');
+        text += i18nc("@info", "Everything it needs is already installed.");
+    }
+
+    m_footprintLabel->setText(text);
+}
+
 void EnhancedDetailsWidget::emitHideButtons()
 {
     emit emitHideButtonsSignal();
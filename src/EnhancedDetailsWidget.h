@@ -37,6 +37,18 @@
 #include <QGraphicsDropShadowEffect>
 #include <QPropertyAnimation>
 #include <QGroupBox>
+#include <QFutureWatcher>
+
+#include "muonapt/DependencyGraph.h"
+
+class QImage;
+class QLineEdit;
+class QListView;
+class QTimer;
+class QUrl;
+
+class InstalledFilesModel;
+class ScreenshotLoader;
 
 namespace QApt {
     class Backend;
@@ -88,9 +100,18 @@ Q_SIGNALS:
 private Q_SLOTS:
     void animateTabTransition(int fromIndex, int toIndex);
     void onTabChanged(int index);
+    void updateFilesStatus();
+    void updateFootprint();
+    void dependencyGraphReady();
+    void loadDetails();
+    void updateAppStreamData();
+    void screenshotLoaded(const QUrl &url, const QImage &thumbnail);
+    void footprintFinished();
 
 private:
     void setupUI();
+    void cancelDetails(bool keepFiles = false);
+    void loadIcon();
     void setupHeader();
     void setupTabs();
     void applyGradientHeader();
@@ -116,14 +137,27 @@ private:
     QLabel *m_descriptionLabel;
     QLabel *m_versionLabel;
     QLabel *m_screenshotLabel; // New screenshot display
+    ScreenshotLoader *m_screenshotLoader;
+    // Delays loading the tabs until the selection stops changing
+    QTimer *m_settleTimer;
     QPushButton *m_installButton;
     QPushButton *m_updateButton;
     QPushButton *m_removeButton;
     
     // Enhanced content components
     QTextBrowser *m_descriptionBrowser;
-    QTextBrowser *m_filesBrowser;
+    QLineEdit *m_filesFilterEdit;
+    QListView *m_filesView;
+    QLabel *m_filesStatusLabel;
+    InstalledFilesModel *m_filesModel;
     QTextBrowser *m_dependenciesBrowser;
+    QLabel *m_footprintLabel;
+    QFutureWatcher<DependencyGraphData::Closure> *m_footprintWatcher;
+    quint32 m_footprintGeneration;
+    // Bumped when the selection changes, so late results are dropped
+    quint64 m_detailsGeneration;
+    // Also bumped per Dependencies tab refresh; only the latest is shown
+    quint64 m_dependenciesRequest;
     QTextBrowser *m_versionsBrowser;
     QTextBrowser *m_reverseDepsBrowser;
     
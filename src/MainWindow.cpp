@@ -22,6 +22,7 @@
 
 // Qt includes
 #include <QApplication>
+#include <QDockWidget>
 #include <QStringBuilder>
 #include <QTimer>
 #include <QSplitter>
@@ -61,6 +62,8 @@
 
 // Own includes
 #include "muonapt/MuonStrings.h"
+#include "TransactionQueue.h"
+#include "TransactionQueueWidget.h"
 #include "TransactionWidget.h"
 #include "FilterWidget/FilterWidget.h"
 #include "ManagerWidget.h"
@@ -68,7 +71,10 @@
 #include "MuonSettings.h"
 #include "StatusWidget.h"
 #include "config/ManagerSettingsDialog.h"
+#include "muonapt/MarkingJournal.h"
 #include "muonapt/QAptActions.h"
+#include "muonapt/DependencyGraph.h"
+#include "muonapt/ArchivePrefetcher.h"
 #include "PackageModel/LocalPackageManager.h"
 #include "Dashboard/DashboardWidget.h"
 
@@ -77,6 +83,7 @@ MainWindow::MainWindow()
     , m_settingsDialog(nullptr)
     , m_reviewWidget(nullptr)
     , m_transWidget(nullptr)
+    , m_queueDock(nullptr)
     , m_dashboardWidget(nullptr)
     , m_reloading(false)
     , m_qmlEngine(nullptr)
@@ -265,6 +272,24 @@ void MainWindow::initGUI()
     m_stack->addWidget(m_transWidget);
     m_stack->addWidget(m_mainWidget);
     m_stack->addWidget(m_mainWidget);
+
+    TransactionQueueWidget *queueWidget = new TransactionQueueWidget(TransactionQueue::instance(), this);
+    connect(queueWidget, &TransactionQueueWidget::showProgressRequested, this, [this]() {
+        m_stack->setCurrentWidget(m_transWidget);
+    });
+    connect(queueWidget, &TransactionQueueWidget::showPackagesRequested, this, [this]() {
+        m_stack->setCurrentWidget(m_mainWidget);
+    });
+
+    m_queueDock = new QDockWidget(i18nc("@title:window", "Transaction Queue"), this);
+    m_queueDock->setObjectName(QStringLiteral("transactionQueueDock"));
+    m_queueDock->setWidget(queueWidget);
+    addDockWidget(Qt::BottomDockWidgetArea, m_queueDock);
+    m_queueDock->hide();
+    connect(TransactionQueue::instance(), &TransactionQueue::itemQueued,
+            m_queueDock, &QDockWidget::show);
+    connect(TransactionQueue::instance(), &TransactionQueue::aptTransactionStarted,
+            this, &MainWindow::queuedTransactionStarted);
     // m_stack->setCurrentWidget(m_mainWidget); // Removed to keep Dashboard as start screen
 
     m_backend = new QApt::Backend(this);
@@ -294,6 +319,9 @@ void MainWindow::initGUI()
 void MainWindow::initObject()
 {
     QAptActions::self()->setBackend(m_backend);
+    DependencyGraph::instance()->setBackend(m_backend);
+    ArchivePrefetcher::instance()->setBackend(m_backend);
+    TransactionQueue::instance()->setBackend(m_backend);
     
     // Initialize local package manager with delay to avoid blocking UI
     QTimer::singleShot(1000, this, [this]() {
@@ -355,7 +383,7 @@ void MainWindow::initObject()
 
 void MainWindow::loadSettings()
 {
-    m_backend->setUndoRedoCacheSize(MuonSettings::self()->undoStackSize());
+    QAptActions::self()->journal()->setMaximumSteps(MuonSettings::self()->undoStackSize());
     m_managerWidget->invalidateFilter();
     
     // Update LocalPackageManager settings
@@ -437,8 +465,8 @@ void MainWindow::setupActions()
     updateAction->setToolTip(i18nc("@info:tooltip", "Check for package updates"));
     actionCollection()->setDefaultShortcut(updateAction, QKeySequence(Qt::ControlModifier | Qt::Key_R));
     connect(updateAction, SIGNAL(triggered()), SLOT(checkForUpdates()));
+    // QAptActions keeps it disabled while offline or while the queue runs
     updateAction->setEnabled(QAptActions::self()->isConnected());
-    connect(QAptActions::self(), SIGNAL(shouldConnect(bool)), updateAction, SLOT(setEnabled(bool)));
 
     KStandardAction::preferences(this, SLOT(editSettings()), actionCollection());
 
@@ -469,6 +497,10 @@ void MainWindow::setupActions()
     m_installLocalPackageAction->setToolTip(i18nc("@info:tooltip", "Install a local .deb package file"));
     connect(m_installLocalPackageAction, SIGNAL(triggered()), this, SLOT(installLocalPackage()));
 
+    QAction *queueAction = m_queueDock->toggleViewAction();
+    queueAction->setIcon(QIcon::fromTheme("view-process-system"));
+    actionCollection()->addAction("show_transaction_queue", queueAction);
+
     setActionsEnabled(false);
 
     setupGUI(StandardWindowOption(KXmlGuiWindow::Default & ~KXmlGuiWindow::StatusBar));
@@ -500,7 +532,7 @@ void MainWindow::setFocusSearchEdit()
 
 void MainWindow::markUpgrade()
 {
-    m_backend->saveCacheState();
+    QAptActions::self()->journal()->checkpoint();
     m_backend->markPackagesForUpgrade();
 
     if (m_backend-> markedPackages().isEmpty()) {
@@ -518,7 +550,7 @@ void MainWindow::markUpgrade()
 
 void MainWindow::markDistUpgrade()
 {
-    m_backend->saveCacheState();
+    QAptActions::self()->journal()->checkpoint();
     m_backend->markPackagesForDistUpgrade();
     if (m_backend-> markedPackages().isEmpty()) {
         QString text = i18nc("@label", "Unable to mark upgrades. Some "
@@ -533,7 +565,7 @@ void MainWindow::markDistUpgrade()
 
 void MainWindow::markAutoRemove()
 {
-    m_backend->saveCacheState();
+    QAptActions::self()->journal()->checkpoint();
     m_backend->markPackagesForAutoRemove();
     previewChanges();
 }
@@ -552,6 +584,12 @@ void MainWindow::handleDashboardUpdate()
 
 void MainWindow::checkForUpdates()
 {
+    if (m_trans || TransactionQueue::instance()->isAptBusy()) {
+        KMessageBox::information(this, i18nc("@info", "Updates can be checked for once the queued changes have been applied."),
+                                 i18nc("@title:window", "Queue Busy"));
+        return;
+    }
+
     setActionsEnabled(false);
     m_managerWidget->setEnabled(false);
 
@@ -586,13 +624,19 @@ void MainWindow::transactionStatusChanged(QApt::TransactionStatus status)
         QApplication::restoreOverrideCursor();
         m_stack->setCurrentWidget(m_transWidget);
         break;
-    case QApt::FinishedStatus:
+    case QApt::FinishedStatus: {
+        // Changes marked while the transaction ran do not survive the reload
+        const TransactionQueue::ChangeSet pending = TransactionQueue::instance()->captureChanges();
         reload();
-        setActionsEnabled();
 
         m_trans->deleteLater();
         m_trans = nullptr;
+
+        TransactionQueue::instance()->runNextAptItem();
+        TransactionQueue::instance()->applyChanges(pending);
+        setActionsEnabled();
         break;
+    }
     default:
         break;
     }
@@ -643,14 +687,22 @@ void MainWindow::startCommit()
     }
     
     // Force traditional method for now - KAuth action files are not properly configured
-    // Traditional method
-    setActionsEnabled(false);
-    m_managerWidget->setEnabled(false);
-    QApplication::setOverrideCursor(Qt::WaitCursor);
+    // Traditional method; the queue runs it now or after what is already queued
+    TransactionQueue::instance()->enqueueCommit();
+}
+
+void MainWindow::queuedTransactionStarted(QApt::Transaction *trans, qint64 expectedDuration)
+{
+    // The commit brings everything it needs itself
+    ArchivePrefetcher::instance()->stop();
 
+    QApplication::setOverrideCursor(Qt::WaitCursor);
     m_stack->setCurrentWidget(m_transWidget);
-    m_trans = m_backend->commitChanges();
+    m_trans = trans;
     setupTransaction(m_trans);
+    if (m_trans->role() == QApt::CommitChangesRole) {
+        m_transWidget->setExpectedDuration(expectedDuration);
+    }
 
     m_trans->run();
 }
@@ -734,6 +786,15 @@ void MainWindow::downloadArchives(QApt::Transaction *trans)
         return;
     }
 
+    if (m_trans) {
+        // Another transaction owns the transaction view; this one never ran
+        trans->deleteLater();
+        KMessageBox::information(this, i18nc("@info", "Packages can be downloaded once the queued changes have been applied."),
+                                 i18nc("@title:window", "Queue Busy"));
+        setActionsEnabled();
+        return;
+    }
+
     m_stack->setCurrentWidget(m_transWidget);
     m_trans = trans;
     setupTransaction(trans);
@@ -1096,13 +1157,6 @@ void MainWindow::installLocalPackageFile(const QString &fileName)
         return;
     }
     
-    // Install the package
-    setActionsEnabled(false);
-    m_managerWidget->setEnabled(false);
-    QApplication::setOverrideCursor(Qt::WaitCursor);
-    
-    m_stack->setCurrentWidget(m_transWidget);
-    
     // Create DebFile object from filename
     QApt::DebFile debFile(fileName);
     
@@ -1115,10 +1169,8 @@ void MainWindow::installLocalPackageFile(const QString &fileName)
     
     qDebug() << "Installing local package:" << fileName << "Valid:" << debFile.isValid();
     
-    m_trans = m_backend->installFile(debFile);
-    setupTransaction(m_trans);
-    
-    m_trans->run();
+    // Install the package
+    TransactionQueue::instance()->enqueueLocalFile(fileName);
 }
 
 void MainWindow::openDebFile(const QString &debFilePath)
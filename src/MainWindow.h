@@ -25,6 +25,7 @@
 #include <KXmlGuiWindow>
 #include <QApt/Globals>
 
+class QDockWidget;
 class QSplitter;
 class QStackedWidget;
 class QToolBox;
@@ -89,6 +90,7 @@ private:
     ManagerWidget *m_managerWidget;
     ReviewWidget *m_reviewWidget;
     TransactionWidget *m_transWidget;
+    QDockWidget *m_queueDock;
     DashboardWidget *m_dashboardWidget; // New Dashboard
     StatusWidget *m_statusWidget;
     bool m_reloading;
@@ -122,6 +124,7 @@ private Q_SLOTS:
     void reload();
     void setActionsEnabled(bool enabled = true);
     void downloadArchives(QApt::Transaction *trans);
+    void queuedTransactionStarted(QApt::Transaction *trans, qint64 expectedDuration);
     void applyKDEColorScheme();
     void addLocalFolder();
     void installLocalPackage();
@@ -0,0 +1,96 @@
+/*
+ *  Local archive verification for Kydra Package Manager
+ *  Copyright (C) 2025 Kydra Project
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "ArchiveVerifier.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QFile>
+#include <QStringBuilder>
+#include <QTextStream>
+#include <QUrl>
+
+QHash<QString, ArchiveVerifier::IndexRecord> ArchiveVerifier::parseIndex(const QByteArray &output)
+{
+    QHash<QString, IndexRecord> records;
+    QString package;
+    QString version;
+    IndexRecord record = { QByteArray(), -1 };
+
+    QTextStream stream(output);
+    QString line;
+    while (stream.readLineInto(&line)) {
+        if (line.isEmpty()) {
+            if (!package.isEmpty() && !record.sha256.isEmpty()) {
+                records.insert(package % QLatin1Char('=') % version, record);
+            }
+            package.clear();
+            version.clear();
+            record = { QByteArray(), -1 };
+        } else if (line.startsWith(QLatin1String("Package: "))) {
+            package = line.mid(9).trimmed();
+        } else if (line.startsWith(QLatin1String("Version: "))) {
+            version = line.mid(9).trimmed();
+        } else if (line.startsWith(QLatin1String("SHA256: "))) {
+            record.sha256 = line.mid(8).trimmed().toLatin1().toLower();
+        } else if (line.startsWith(QLatin1String("Size: "))) {
+            record.size = line.mid(6).trimmed().toLongLong();
+        }
+    }
+    if (!package.isEmpty() && !record.sha256.isEmpty()) {
+        records.insert(package % QLatin1Char('=') % version, record);
+    }
+
+    return records;
+}
+
+QStringList ArchiveVerifier::downloadList(const QVector<Candidate> &candidates,
+                                          const QHash<QString, IndexRecord> &index)
+{
+    QStringList lines;
+    for (const Candidate &candidate : candidates) {
+        const auto it = index.constFind(candidate.name % QLatin1Char('=') % candidate.version);
+        if (it == index.constEnd()) {
+            continue;
+        }
+
+        QFile file(candidate.filePath);
+        if (file.size() != it->size || !file.open(QIODevice::ReadOnly)) {
+            continue;
+        }
+
+        QCryptographicHash hash(QCryptographicHash::Sha256);
+        if (!hash.addData(&file) || hash.result().toHex() != it->sha256) {
+            qDebug() << "Local archive" << candidate.filePath << "does not match the index";
+            continue;
+        }
+
+        QString escapedVersion = candidate.version;
+        escapedVersion.replace(QLatin1Char(':'), QLatin1String("%3a"));
+        const QString archiveName = candidate.name % QLatin1Char('_') % escapedVersion
+                                  % QLatin1Char('_') % candidate.architecture % QLatin1String(".deb");
+
+        lines << QLatin1Char('\'') % QUrl::fromLocalFile(candidate.filePath).toString(QUrl::FullyEncoded)
+                 % QLatin1String("' ") % archiveName
+                 % QLatin1Char(' ') % QString::number(it->size)
+                 % QLatin1String(" SHA256:") % QString::fromLatin1(it->sha256);
+    }
+
+    return lines;
+}
@@ -0,0 +1,59 @@
+/*
+ *  Local archive verification for Kydra Package Manager
+ *  Copyright (C) 2025 Kydra Project
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef ARCHIVEVERIFIER_H
+#define ARCHIVEVERIFIER_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * Matches local .deb files against APT's Packages index for
+ * LocalArchiveSeeder. A file is only used when its size and SHA256 equal
+ * what the index lists for the same name and version.
+ */
+class ArchiveVerifier
+{
+public:
+    struct Candidate {
+        QString name;
+        QString version;
+        QString architecture;
+        QString filePath;
+    };
+
+    struct IndexRecord {
+        QByteArray sha256;
+        qint64 size;
+    };
+
+    /// Reads SHA256 and Size by "name=version" from the output of apt-cache show
+    static QHash<QString, IndexRecord> parseIndex(const QByteArray &output);
+
+    /**
+     * @returns download list lines, in apt-get --print-uris format, for the
+     * candidates whose local file matches @p index
+     */
+    static QStringList downloadList(const QVector<Candidate> &candidates,
+                                    const QHash<QString, IndexRecord> &index);
+};
+
+#endif // ARCHIVEVERIFIER_H
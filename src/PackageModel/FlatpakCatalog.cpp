@@ -0,0 +1,398 @@
+/*
+ *  Flatpak catalog for Kydra Package Manager
+ *  Copyright (C) 2025 Kydra Project
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "FlatpakCatalog.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <QStringBuilder>
+#include <QTimer>
+#include <QXmlStreamReader>
+#include <QtConcurrent>
+
+#include <KCompressionDevice>
+
+// Bump when the layout of the cached catalog changes
+static const quint32 s_catalogCacheVersion = 1;
+
+QDataStream &operator<<(QDataStream &stream, const FlatpakPackage &pkg)
+{
+    return stream << pkg.id << pkg.name << pkg.description << pkg.version
+                  << pkg.arch << pkg.branch << pkg.remote << pkg.downloadSize;
+}
+
+QDataStream &operator>>(QDataStream &stream, FlatpakPackage &pkg)
+{
+    stream >> pkg.id >> pkg.name >> pkg.description >> pkg.version
+           >> pkg.arch >> pkg.branch >> pkg.remote >> pkg.downloadSize;
+    pkg.isInstalled = false;
+    pkg.section = QStringLiteral("Flatpak");
+    return stream;
+}
+
+static QString catalogCachePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+            + QLatin1String("/flatpak-catalog");
+}
+
+// The catalog of every remote and architecture, preferring the compressed
+// one flatpak writes next to the plain XML
+static QStringList catalogFiles(const QStringList &roots)
+{
+    QStringList files;
+    for (const QString &root : roots) {
+        const QDir rootDir(root);
+        const QStringList remotes = rootDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+        for (const QString &remote : remotes) {
+            const QDir remoteDir(rootDir.filePath(remote));
+            const QStringList arches = remoteDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot, QDir::Name);
+            for (const QString &arch : arches) {
+                const QString active = remoteDir.filePath(arch) + QLatin1String("/active/");
+                if (QFileInfo::exists(active + QLatin1String("appstream.xml.gz"))) {
+                    files.append(active + QLatin1String("appstream.xml.gz"));
+                } else if (QFileInfo::exists(active + QLatin1String("appstream.xml"))) {
+                    files.append(active + QLatin1String("appstream.xml"));
+                }
+            }
+        }
+    }
+    return files;
+}
+
+// "active" links to the checkout of the current commit, so the resolved
+// path changes along with the data
+static QByteArray catalogFingerprint(const QStringList &files)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (const QString &path : files) {
+        const QFileInfo info(path);
+        hash.addData((info.canonicalFilePath() % QLatin1Char(' ')
+                      % QString::number(info.size()) % QLatin1Char(' ')
+                      % QString::number(info.lastModified().toMSecsSinceEpoch())).toUtf8());
+    }
+    return hash.result();
+}
+
+static bool readCatalogCache(const QByteArray &fingerprint, QList<FlatpakPackage> *packages)
+{
+    QFile file(catalogCachePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    quint32 version = 0;
+    QByteArray cachedFingerprint;
+    stream >> version >> cachedFingerprint;
+    if (version != s_catalogCacheVersion || cachedFingerprint != fingerprint) {
+        return false;
+    }
+
+    stream >> *packages;
+    return stream.status() == QDataStream::Ok;
+}
+
+static void writeCatalogCache(const QByteArray &fingerprint, const QList<FlatpakPackage> &packages)
+{
+    QDir().mkpath(QFileInfo(catalogCachePath()).absolutePath());
+
+    QSaveFile file(catalogCachePath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream << s_catalogCacheVersion << fingerprint << packages;
+    file.commit();
+}
+
+// The remote is the directory two levels above "active"
+static QString remoteOf(const QString &catalogPath)
+{
+    const QStringList parts = catalogPath.split(QLatin1Char('/'), Qt::SkipEmptyParts);
+    return parts.size() >= 4 ? parts.at(parts.size() - 4) : QString();
+}
+
+static QList<FlatpakPackage> loadCatalog(const QStringList &roots)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    const QStringList files = catalogFiles(roots);
+    const QByteArray fingerprint = catalogFingerprint(files);
+    QList<FlatpakPackage> packages;
+    if (readCatalogCache(fingerprint, &packages)) {
+        qDebug() << "Flatpak catalog read from cache in" << timer.elapsed() << "ms";
+        return packages;
+    }
+
+    // An application offered by several remotes is listed once, from the
+    // first remote in name order
+    QSet<QString> seen;
+    for (const QString &path : files) {
+        KCompressionDevice device(path, path.endsWith(QLatin1String(".gz"))
+                                  ? KCompressionDevice::GZip : KCompressionDevice::None);
+        if (!device.open(QIODevice::ReadOnly)) {
+            qWarning() << "Cannot read Flatpak catalog" << path;
+            continue;
+        }
+
+        const QList<FlatpakPackage> remotePackages = FlatpakCatalog::parse(&device, remoteOf(path));
+        for (const FlatpakPackage &pkg : remotePackages) {
+            if (!seen.contains(pkg.id)) {
+                seen.insert(pkg.id);
+                packages.append(pkg);
+            }
+        }
+    }
+
+    writeCatalogCache(fingerprint, packages);
+    qDebug() << "Flatpak catalog of" << packages.size() << "applications parsed in" << timer.elapsed() << "ms";
+    return packages;
+}
+
+static void parseSize(QXmlStreamReader &xml, FlatpakPackage *pkg)
+{
+    if (xml.attributes().value(QLatin1String("type")) == QLatin1String("download")) {
+        pkg->downloadSize = xml.readElementText().toLongLong();
+    } else {
+        xml.skipCurrentElement();
+    }
+}
+
+// Version and download size of the newest release, which comes first
+static void parseRelease(QXmlStreamReader &xml, FlatpakPackage *pkg)
+{
+    pkg->version = xml.attributes().value(QLatin1String("version")).toString();
+
+    while (xml.readNextStartElement()) {
+        if (xml.name() == QLatin1String("size")) {
+            parseSize(xml, pkg);
+        } else if (xml.name() == QLatin1String("sizes")) {
+            while (xml.readNextStartElement()) {
+                parseSize(xml, pkg);
+            }
+        } else {
+            xml.skipCurrentElement();
+        }
+    }
+}
+
+static FlatpakPackage parseComponent(QXmlStreamReader &xml, const QString &remote)
+{
+    FlatpakPackage pkg;
+    pkg.remote = remote;
+    pkg.isInstalled = false;
+    pkg.section = QStringLiteral("Flatpak");
+
+    while (xml.readNextStartElement()) {
+        const QString element = xml.name().toString();
+        if (element == QLatin1String("bundle")) {
+            // app/<id>/<arch>/<branch>; runtimes are not listed
+            const bool isFlatpak = xml.attributes().value(QLatin1String("type")) == QLatin1String("flatpak");
+            const QStringList ref = xml.readElementText().split(QLatin1Char('/'));
+            if (isFlatpak && ref.size() == 4 && ref.at(0) == QLatin1String("app")) {
+                pkg.id = ref.at(1);
+                pkg.arch = ref.at(2);
+                pkg.branch = ref.at(3);
+            }
+        } else if (element == QLatin1String("name") || element == QLatin1String("summary")) {
+            // Untranslated text only
+            const bool translated = xml.attributes().hasAttribute(QLatin1String("xml:lang"));
+            const QString text = xml.readElementText(QXmlStreamReader::IncludeChildElements).simplified();
+            if (translated) {
+                continue;
+            }
+            if (element == QLatin1String("name")) {
+                pkg.name = text;
+            } else {
+                pkg.description = text;
+            }
+        } else if (element == QLatin1String("releases")) {
+            if (xml.readNextStartElement()) {
+                if (xml.name() == QLatin1String("release")) {
+                    parseRelease(xml, &pkg);
+                } else {
+                    xml.skipCurrentElement();
+                }
+                // Older releases
+                while (xml.readNextStartElement()) {
+                    xml.skipCurrentElement();
+                }
+            }
+        } else {
+            xml.skipCurrentElement();
+        }
+    }
+
+    if (pkg.name.isEmpty()) {
+        pkg.name = pkg.id;
+    }
+    return pkg;
+}
+
+QList<FlatpakPackage> FlatpakCatalog::parse(QIODevice *device, const QString &remote)
+{
+    QList<FlatpakPackage> packages;
+    QXmlStreamReader xml(device);
+
+    while (!xml.atEnd()) {
+        xml.readNext();
+        if (xml.isStartElement() && xml.name() == QLatin1String("component")) {
+            const FlatpakPackage pkg = parseComponent(xml, remote);
+            if (!pkg.id.isEmpty()) {
+                packages.append(pkg);
+            }
+        }
+    }
+
+    if (xml.hasError()) {
+        qWarning() << "Flatpak catalog of" << remote << "is malformed:" << xml.errorString();
+    }
+
+    return packages;
+}
+
+FlatpakCatalog::FlatpakCatalog(QObject *parent)
+    : QObject(parent)
+    , m_roots({ QStringLiteral("/var/lib/flatpak/appstream"),
+                QDir::homePath() + QLatin1String("/.local/share/flatpak/appstream") })
+    , m_watcher(new QFutureWatcher<QList<FlatpakPackage>>(this))
+    , m_rootWatcher(new QFileSystemWatcher(this))
+    , m_changeTimer(new QTimer(this))
+    , m_reloadPending(false)
+    , m_ready(false)
+{
+    connect(m_watcher, &QFutureWatcher<QList<FlatpakPackage>>::finished,
+            this, &FlatpakCatalog::loadFinished);
+
+    m_changeTimer->setSingleShot(true);
+    m_changeTimer->setInterval(1000);
+    connect(m_changeTimer, &QTimer::timeout, this, &FlatpakCatalog::load);
+    connect(m_rootWatcher, &QFileSystemWatcher::directoryChanged,
+            m_changeTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
+}
+
+FlatpakCatalog::~FlatpakCatalog()
+{
+    m_watcher->waitForFinished();
+}
+
+void FlatpakCatalog::setCatalogRoots(const QStringList &roots)
+{
+    m_roots = roots;
+}
+
+QStringList FlatpakCatalog::catalogRoots() const
+{
+    return m_roots;
+}
+
+void FlatpakCatalog::load()
+{
+    if (m_watcher->isRunning()) {
+        m_reloadPending = true;
+        return;
+    }
+
+    m_watcher->setFuture(QtConcurrent::run(loadCatalog, m_roots));
+}
+
+void FlatpakCatalog::loadFinished()
+{
+    if (m_reloadPending) {
+        m_reloadPending = false;
+        load();
+        return;
+    }
+
+    // Remotes may have come or gone since the last load
+    watchRoots();
+
+    m_packages = m_watcher->result();
+    m_index.clear();
+    m_index.reserve(m_packages.size());
+    for (int i = 0; i < m_packages.size(); ++i) {
+        m_index.insert(m_packages.at(i).id, i);
+    }
+
+    m_ready = true;
+    emit ready();
+}
+
+void FlatpakCatalog::watchRoots()
+{
+    // flatpak switches the "active" link in <remote>/<arch>/ to a new
+    // checkout when it updates a catalog; the roots see remotes change
+    QStringList directories;
+    for (const QString &root : qAsConst(m_roots)) {
+        const QDir rootDir(root);
+        if (!rootDir.exists()) {
+            continue;
+        }
+        directories.append(root);
+        const QStringList remotes = rootDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+        for (const QString &remote : remotes) {
+            const QDir remoteDir(rootDir.filePath(remote));
+            directories.append(remoteDir.path());
+            const QStringList arches = remoteDir.entryList(QDir::Dirs | QDir::NoDotAndDotDot);
+            for (const QString &arch : arches) {
+                directories.append(remoteDir.filePath(arch));
+            }
+        }
+    }
+
+    if (!m_rootWatcher->directories().isEmpty()) {
+        m_rootWatcher->removePaths(m_rootWatcher->directories());
+    }
+    if (!directories.isEmpty()) {
+        m_rootWatcher->addPaths(directories);
+    }
+}
+
+bool FlatpakCatalog::isReady() const
+{
+    return m_ready;
+}
+
+QList<FlatpakPackage> FlatpakCatalog::packages() const
+{
+    return m_packages;
+}
+
+bool FlatpakCatalog::contains(const QString &id) const
+{
+    return m_index.contains(id);
+}
+
+FlatpakPackage FlatpakCatalog::package(const QString &id) const
+{
+    const int i = m_index.value(id, -1);
+    return i == -1 ? FlatpakPackage() : m_packages.at(i);
+}
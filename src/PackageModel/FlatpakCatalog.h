@@ -0,0 +1,86 @@
+/*
+ *  Flatpak catalog for Kydra Package Manager
+ *  Copyright (C) 2025 Kydra Project
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef FLATPAKCATALOG_H
+#define FLATPAKCATALOG_H
+
+#include <QObject>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QStringList>
+
+#include "FlatpakManager.h"
+
+class QFileSystemWatcher;
+class QIODevice;
+class QTimer;
+
+/**
+ * The applications the configured Flatpak remotes offer, read from the
+ * AppStream data flatpak keeps for each of them under
+ * <root>/<remote>/<arch>/active/, so listing them needs no flatpak process.
+ *
+ * Parsing happens on a worker thread. The result is cached and reused until
+ * one of the catalogs changes. The remote folders are watched, so catalogs
+ * updated by flatpak itself, another frontend or a timer are picked up.
+ */
+class FlatpakCatalog : public QObject
+{
+    Q_OBJECT
+public:
+    explicit FlatpakCatalog(QObject *parent = nullptr);
+    ~FlatpakCatalog();
+
+    /// Directories holding one folder per remote; the system and user installations by default
+    void setCatalogRoots(const QStringList &roots);
+    QStringList catalogRoots() const;
+
+    /// (Re)reads the catalogs in the background; emits ready() when done
+    void load();
+    bool isReady() const;
+
+    QList<FlatpakPackage> packages() const;
+    bool contains(const QString &id) const;
+    FlatpakPackage package(const QString &id) const;
+
+    /// Reads the applications of one AppStream catalog of @p remote
+    static QList<FlatpakPackage> parse(QIODevice *device, const QString &remote);
+
+Q_SIGNALS:
+    void ready();
+
+private:
+    QStringList m_roots;
+    QList<FlatpakPackage> m_packages;
+    // Application id -> index into m_packages
+    QHash<QString, int> m_index;
+    QFutureWatcher<QList<FlatpakPackage>> *m_watcher;
+    QFileSystemWatcher *m_rootWatcher;
+    // Updating a catalog touches several folders; reload once for all of them
+    QTimer *m_changeTimer;
+    bool m_reloadPending;
+    bool m_ready;
+
+    void watchRoots();
+
+private Q_SLOTS:
+    void loadFinished();
+};
+
+#endif // FLATPAKCATALOG_H
@@ -18,10 +18,17 @@
  */
 
 #include "FlatpakManager.h"
+#include "FlatpakCatalog.h"
 
+#include <QPointer>
 #include <QProcess>
 #include <QDebug>
-#include <QtConcurrent>
+#include <QRegularExpression>
+#include <QTimer>
+
+// flatpak locks the installation while it changes it, so running more
+// operations at once would only have them wait on each other
+static const int s_maxRunningOperations = 1;
 
 FlatpakManager *FlatpakManager::s_instance = nullptr;
 
@@ -35,34 +42,83 @@ FlatpakManager *FlatpakManager::instance()
 
 FlatpakManager::FlatpakManager(QObject *parent)
     : QObject(parent)
+    , m_catalog(new FlatpakCatalog(this))
+    , m_nextOperationId(1)
+    , m_listProcess(nullptr)
+    , m_refreshPending(false)
 {
+    connect(m_catalog, &FlatpakCatalog::ready, this, &FlatpakManager::packagesChanged);
 }
 
 FlatpakManager::~FlatpakManager()
 {
+    for (const Operation &operation : m_operations) {
+        if (operation.process) {
+            // A timed out wait would otherwise report the operation as finished
+            operation.process->disconnect(this);
+            operation.process->kill();
+            operation.process->waitForFinished(1000);
+        }
+    }
 }
 
 void FlatpakManager::init()
 {
     refresh();
+    m_catalog->load();
 }
 
 void FlatpakManager::refresh()
 {
-    QtConcurrent::run([this]() {
-        parseInstalled();
-        emit packagesChanged();
+    if (m_listProcess) {
+        // List again once the running one is done, it may predate a change
+        m_refreshPending = true;
+        return;
+    }
+
+    QProcess *process = new QProcess(this);
+    m_listProcess = process;
+    connect(process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+            this, [this, process](int exitCode, QProcess::ExitStatus exitStatus) {
+        listExited(process, exitStatus == QProcess::NormalExit && exitCode == 0);
     });
+    connect(process, &QProcess::errorOccurred, this, [this, process](QProcess::ProcessError error) {
+        switch (error) {
+        case QProcess::FailedToStart: // No flatpak on this system
+        case QProcess::Crashed:
+        case QProcess::Timedout:
+            process->kill();
+            listExited(process, false);
+            break;
+        default:
+            break;
+        }
+    });
+    process->start("flatpak", QStringList() << "list" << "--app" << "--columns=application,name,description,version,arch,branch,origin");
 }
 
-void FlatpakManager::parseInstalled()
+void FlatpakManager::listExited(QProcess *process, bool success)
 {
-    QProcess process;
-    process.start("flatpak", QStringList() << "list" << "--app" << "--columns=application,name,description,version,arch,branch,origin");
-    process.waitForFinished();
-    
-    QString output = process.readAllStandardOutput();
-    QStringList lines = output.split('\n', Qt::SkipEmptyParts);
+    if (process != m_listProcess) {
+        return; // A crash reports both an error and finished()
+    }
+
+    if (success) {
+        parseInstalled(m_listProcess->readAllStandardOutput());
+        emit packagesChanged();
+    }
+    m_listProcess->deleteLater();
+    m_listProcess = nullptr;
+
+    if (m_refreshPending) {
+        m_refreshPending = false;
+        refresh();
+    }
+}
+
+void FlatpakManager::parseInstalled(const QByteArray &output)
+{
+    QStringList lines = QString::fromUtf8(output).split('\n', Qt::SkipEmptyParts);
     
     m_packages.clear();
     
@@ -81,91 +137,199 @@ void FlatpakManager::parseInstalled()
         pkg.isInstalled = true;
         pkg.section = "Flatpak";
         
+        pkg.downloadSize = m_catalog->package(pkg.id).downloadSize;
+        
         m_packages.insert(pkg.id, pkg);
     }
-    
-    // TODO: Also list available packages from remote (e.g. flathub)
-    // This is expensive with CLI "flatpak remote-ls". 
-    // For now, we only show installed Flatpaks or rely on AppStream for discovery.
 }
 
 QList<FlatpakPackage> FlatpakManager::listPackages() const
 {
-    return m_packages.values();
+    QList<FlatpakPackage> packages = m_packages.values();
+
+    const QList<FlatpakPackage> available = m_catalog->packages();
+    for (const FlatpakPackage &pkg : available) {
+        if (!m_packages.contains(pkg.id)) {
+            packages.append(pkg);
+        }
+    }
+    return packages;
 }
 
 FlatpakPackage FlatpakManager::getPackage(const QString &id) const
 {
-    return m_packages.value(id);
+    auto it = m_packages.constFind(id);
+    return it != m_packages.constEnd() ? *it : m_catalog->package(id);
 }
 
 bool FlatpakManager::isFlatpak(const QString &id) const
 {
-    return m_packages.contains(id);
+    return m_packages.contains(id) || m_catalog->contains(id);
 }
 
-void FlatpakManager::installPackage(const QString &id, const QString &remote)
+quint64 FlatpakManager::installPackage(const QString &id, const QString &remote)
 {
-    emit operationStarted("install");
-    
-    // Run in background
-    QtConcurrent::run([this, id, remote]() {
-        QProcess process;
-        // -y for non-interactive
-        process.start("flatpak", QStringList() << "install" << "-y" << remote << id);
-        
-        connect(&process, &QProcess::readyReadStandardOutput, this, [this, &process]() {
-             emit outputAvailable(process.readAllStandardOutput());
-        });
-        
-        bool success = process.waitForFinished(-1); // Wait indefinitely
-        
-        if (success && process.exitCode() == 0) {
-            parseInstalled(); // Refresh list
-            emit packagesChanged();
-            emit operationFinished("install", true);
-        } else {
-            emit operationFinished("install", false);
+    // -y answers the prompts; --noninteractive would also drop the progress output
+    return enqueue("install", QStringList() << "install" << "-y" << remote << id);
+}
+
+quint64 FlatpakManager::removePackage(const QString &id)
+{
+    return enqueue("remove", QStringList() << "uninstall" << "-y" << id);
+}
+
+int FlatpakManager::indexOf(quint64 operationId) const
+{
+    for (int i = 0; i < m_operations.size(); ++i) {
+        if (m_operations.at(i).id == operationId) {
+            return i;
         }
-    });
+    }
+    return -1;
 }
 
-void FlatpakManager::removePackage(const QString &id)
+quint64 FlatpakManager::enqueue(const QString &op, const QStringList &arguments)
 {
-    emit operationStarted("remove");
-    
-    QtConcurrent::run([this, id]() {
-        QProcess process;
-        process.start("flatpak", QStringList() << "uninstall" << "-y" << id);
-        
-        bool success = process.waitForFinished(-1);
-        
-        if (success && process.exitCode() == 0) {
-            parseInstalled();
-            emit packagesChanged();
-            emit operationFinished("remove", true);
-        } else {
-            emit operationFinished("remove", false);
+    Operation operation;
+    operation.id = m_nextOperationId++;
+    operation.op = op;
+    operation.arguments = arguments;
+    operation.process = nullptr;
+    operation.cancelled = false;
+    m_operations.append(operation);
+
+    startOperations();
+    return operation.id;
+}
+
+void FlatpakManager::startOperations()
+{
+    int running = 0;
+    for (const Operation &operation : m_operations) {
+        running += operation.process ? 1 : 0;
+    }
+
+    for (Operation &operation : m_operations) {
+        if (running >= s_maxRunningOperations) {
+            return;
         }
-    });
+        if (operation.process) {
+            continue;
+        }
+
+        const quint64 id = operation.id;
+        operation.process = new QProcess(this);
+        operation.process->setProcessChannelMode(QProcess::MergedChannels);
+        // readOutput() matches the untranslated stage names
+        QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+        environment.insert(QStringLiteral("LC_ALL"), QStringLiteral("C"));
+        operation.process->setProcessEnvironment(environment);
+        connect(operation.process, &QProcess::readyReadStandardOutput, this, [this, id]() {
+            readOutput(id);
+        });
+        connect(operation.process, static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(&QProcess::finished),
+                this, [this, id](int exitCode, QProcess::ExitStatus exitStatus) {
+            operationExited(id, exitStatus == QProcess::NormalExit && exitCode == 0);
+        });
+        connect(operation.process, &QProcess::errorOccurred, this, [this, id](QProcess::ProcessError error) {
+            switch (error) {
+            case QProcess::FailedToStart:
+            case QProcess::Crashed:
+            case QProcess::Timedout:
+                operationExited(id, false);
+                break;
+            default:
+                break;
+            }
+        });
+
+        emit operationStarted(id, operation.op);
+        operation.process->start("flatpak", operation.arguments);
+        ++running;
+    }
 }
 
-void FlatpakManager::updateAll()
+void FlatpakManager::readOutput(quint64 operationId)
 {
-    emit operationStarted("update");
-    
-    QtConcurrent::run([this]() {
-        QProcess process;
-        process.start("flatpak", QStringList() << "update" << "-y");
-        
-        bool success = process.waitForFinished(-1);
-        
-        if (success && process.exitCode() == 0) {
-            parseInstalled();
-            emit packagesChanged();
-            emit operationFinished("update", true);
-        } else {
-            emit operationFinished("update", false);
+    const int index = indexOf(operationId);
+    if (index == -1) {
+        return;
+    }
+
+    Operation &operation = m_operations[index];
+    const QString output = QString::fromUtf8(operation.process->readAllStandardOutput());
+    emit outputAvailable(output);
+
+    // Progress is redrawn in place with carriage returns; every complete
+    // segment is a progress line of its own
+    static const QRegularExpression separator(QStringLiteral("[\r\n]"));
+    static const QRegularExpression percentage(QStringLiteral("(\\d{1,3})%"));
+    static const QRegularExpression stage(QStringLiteral("^\\s*((?:Installing|Uninstalling|Updating|Downloading)[^\\d%]*(?:\\d+/\\d+)?)"));
+
+    operation.pendingOutput += output;
+    QStringList segments = operation.pendingOutput.split(separator);
+    operation.pendingOutput = segments.takeLast();
+
+    for (const QString &segment : segments) {
+        if (segment.trimmed().isEmpty()) {
+            continue;
+        }
+
+        int percent = -1;
+        const QRegularExpressionMatch percentMatch = percentage.match(segment);
+        if (percentMatch.hasMatch()) {
+            percent = qMin(percentMatch.captured(1).toInt(), 100);
+        }
+
+        const QRegularExpressionMatch stageMatch = stage.match(segment);
+        if (percent != -1 || stageMatch.hasMatch()) {
+            const QString stageText = stageMatch.hasMatch()
+                    ? stageMatch.captured(1).trimmed().remove(QChar(0x2026))
+                    : QString();
+            emit operationProgress(operationId, percent, stageText);
+        }
+    }
+}
+
+void FlatpakManager::cancel(quint64 operationId)
+{
+    const int index = indexOf(operationId);
+    if (index == -1) {
+        return;
+    }
+
+    Operation &operation = m_operations[index];
+    if (!operation.process) {
+        const QString op = operation.op;
+        m_operations.removeAt(index);
+        emit operationFinished(operationId, op, false);
+        return;
+    }
+
+    // flatpak aborts its transaction cleanly on SIGTERM; kill it if it hangs
+    operation.cancelled = true;
+    operation.process->terminate();
+    QPointer<QProcess> process = operation.process;
+    QTimer::singleShot(5000, this, [process]() {
+        if (process && process->state() != QProcess::NotRunning) {
+            process->kill();
         }
     });
 }
+
+void FlatpakManager::operationExited(quint64 operationId, bool success)
+{
+    const int index = indexOf(operationId);
+    if (index == -1) {
+        return;
+    }
+
+    const Operation operation = m_operations.takeAt(index);
+    operation.process->deleteLater();
+
+    emit operationFinished(operationId, operation.op, success && !operation.cancelled);
+
+    // Even a cancelled operation may have changed something
+    refresh();
+    startOperations();
+}
@@ -24,6 +24,7 @@
 #include <QHash>
 #include <QList>
 #include <QMap>
+#include <QStringList>
 
 struct FlatpakPackage {
     QString id;
@@ -34,11 +35,25 @@ struct FlatpakPackage {
     QString branch;
     QString remote;
     bool isInstalled;
+    qint64 downloadSize = 0; // From the remote's catalog, 0 when unknown
     
     // For sorting/display
     QString section; // e.g. "Flatpak"
 };
 
+class FlatpakCatalog;
+class QProcess;
+
+/**
+ * Lists installed Flatpak applications, along with those the remotes offer
+ * according to their catalogs, and installs, removes and updates them
+ * through the flatpak command line tool.
+ *
+ * All processes are driven by their signals on the GUI thread; nothing
+ * waits on them and no thread pool thread is used. Modifying operations are
+ * queued and only s_maxRunningOperations run at once. Their progress output
+ * is parsed into a stage description and a percentage.
+ */
 class FlatpakManager : public QObject
 {
     Q_OBJECT
@@ -48,32 +63,59 @@ public:
 
     void init();
     
+    // Installed applications followed by the ones available to install
     QList<FlatpakPackage> listPackages() const;
     FlatpakPackage getPackage(const QString &id) const;
     
     bool isFlatpak(const QString &id) const;
 
+    /// Stops a queued or running operation; it finishes as unsuccessful
+    void cancel(quint64 operationId);
+
 public slots:
-    void installPackage(const QString &id, const QString &remote = "flathub");
-    void removePackage(const QString &id);
-    void updateAll();
+    // Each returns the id the operation is reported under
+    quint64 installPackage(const QString &id, const QString &remote = "flathub");
+    quint64 removePackage(const QString &id);
     void refresh();
 
 signals:
     void packagesChanged();
-    void operationStarted(const QString &op);
-    void operationFinished(const QString &op, bool success);
+    void operationStarted(quint64 operationId, const QString &op);
+    /// @p percent is -1 while flatpak reports no percentage
+    void operationProgress(quint64 operationId, int percent, const QString &stage);
+    void operationFinished(quint64 operationId, const QString &op, bool success);
     void outputAvailable(const QString &output);
 
 private:
     explicit FlatpakManager(QObject *parent = nullptr);
     ~FlatpakManager();
 
-    void parseInstalled();
-    void parseRemotes(); // To list available apps (simplified for now)
+    struct Operation {
+        quint64 id;
+        QString op;
+        QStringList arguments;
+        QProcess *process;
+        QString pendingOutput;
+        bool cancelled;
+    };
+
+    void listExited(QProcess *process, bool success);
+    void parseInstalled(const QByteArray &output);
+
+    quint64 enqueue(const QString &op, const QStringList &arguments);
+    void startOperations();
+    void readOutput(quint64 operationId);
+    void operationExited(quint64 operationId, bool success);
+    int indexOf(quint64 operationId) const;
 
     static FlatpakManager *s_instance;
     QMap<QString, FlatpakPackage> m_packages;
+    FlatpakCatalog *m_catalog;
+
+    QList<Operation> m_operations;
+    quint64 m_nextOperationId;
+    QProcess *m_listProcess;
+    bool m_refreshPending;
 };
 
 #endif // FLATPAKMANAGER_H
@@ -0,0 +1,154 @@
+/*
+ *  Local archive seeding for Kydra Package Manager
+ *  Copyright (C) 2025 Kydra Project
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "LocalArchiveSeeder.h"
+
+#include <QDebug>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QProcess>
+#include <QStringBuilder>
+#include <QTimer>
+#include <QtConcurrent>
+
+#include <QApt/Backend>
+#include <QApt/Package>
+#include <QApt/Transaction>
+
+#include "ArchiveVerifier.h"
+#include "LocalPackageManager.h"
+#include "muonapt/ArchivePrefetcher.h"
+
+namespace {
+
+// Reads SHA256 and Size of the given versions from the Packages index
+QHash<QString, ArchiveVerifier::IndexRecord> indexRecords(const QVector<ArchiveVerifier::Candidate> &candidates)
+{
+    QStringList arguments;
+    arguments << QStringLiteral("show");
+    for (const ArchiveVerifier::Candidate &candidate : candidates) {
+        arguments << candidate.name % QLatin1Char(':') % candidate.architecture
+                     % QLatin1Char('=') % candidate.version;
+    }
+
+    QProcess process;
+    process.start(QStringLiteral("apt-cache"), arguments);
+    process.waitForFinished(-1);
+    return ArchiveVerifier::parseIndex(process.readAllStandardOutput());
+}
+
+QStringList verifyCandidates(const QVector<ArchiveVerifier::Candidate> &candidates)
+{
+    return ArchiveVerifier::downloadList(candidates, indexRecords(candidates));
+}
+
+}
+
+LocalArchiveSeeder::LocalArchiveSeeder(QObject *parent)
+    : QObject(parent)
+    , m_backend(nullptr)
+{
+    m_watcher = new QFutureWatcher<QStringList>(this);
+    connect(m_watcher, &QFutureWatcher<QStringList>::finished,
+            this, &LocalArchiveSeeder::verified);
+}
+
+void LocalArchiveSeeder::seed(QApt::Backend *backend)
+{
+    m_backend = backend;
+
+    LocalPackageManager *localManager = LocalPackageManager::instance();
+    ArchivePrefetcher *prefetcher = ArchivePrefetcher::instance();
+    const int fetchStates = QApt::Package::ToInstall | QApt::Package::ToUpgrade
+                          | QApt::Package::ToReInstall | QApt::Package::ToDowngrade;
+
+    QVector<ArchiveVerifier::Candidate> candidates;
+    if (localManager && !localManager->localDebFolders().isEmpty()) {
+        for (QApt::Package *package : m_backend->markedPackages()) {
+            if (!(package->state() & fetchStates) || !localManager->hasLocalFile(package->name())
+                    || prefetcher->isArchiveCached(package)) {
+                continue;
+            }
+
+            const LocalPackageInfo info = localManager->localPackageInfo(package->name());
+            if (info.version != package->availableVersion()) {
+                continue;
+            }
+            if (info.architecture != package->architecture() && info.architecture != QLatin1String("all")) {
+                continue;
+            }
+
+            candidates.append({ package->name(), info.version, info.architecture, info.filename });
+        }
+    }
+
+    if (candidates.isEmpty() || !m_listDir.isValid()) {
+        // Callers connect after seeding, so report from the event loop
+        QTimer::singleShot(0, this, [this]() { emit finished(0); });
+        return;
+    }
+
+    m_watcher->setFuture(QtConcurrent::run(verifyCandidates, candidates));
+}
+
+void LocalArchiveSeeder::verified()
+{
+    const QStringList lines = m_watcher->result();
+    if (lines.isEmpty()) {
+        emit finished(0);
+        return;
+    }
+
+    const QString listFile = m_listDir.path() % QLatin1String("/seed-list");
+    QFile file(listFile);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        emit finished(0);
+        return;
+    }
+    file.write(lines.join(QLatin1Char('\n')).toUtf8());
+    file.write("\n");
+    file.close();
+
+    m_trans = m_backend->downloadArchives(listFile, ArchivePrefetcher::instance()->archiveDirectory());
+    if (!m_trans) {
+        emit finished(0);
+        return;
+    }
+
+    m_trans->setProperty("seededArchives", lines.size());
+    connect(m_trans.data(), &QApt::Transaction::statusChanged,
+            this, &LocalArchiveSeeder::transactionStatusChanged);
+    qDebug() << "Seeding" << lines.size() << "archives from local folders";
+    m_trans->run();
+}
+
+void LocalArchiveSeeder::transactionStatusChanged(QApt::TransactionStatus status)
+{
+    if (status != QApt::FinishedStatus) {
+        return;
+    }
+
+    const int count = m_trans->exitStatus() == QApt::ExitSuccess
+            ? m_trans->property("seededArchives").toInt() : 0;
+    m_trans->deleteLater();
+    m_trans = nullptr;
+
+    emit finished(count);
+}
@@ -0,0 +1,71 @@
+/*
+ *  Local archive seeding for Kydra Package Manager
+ *  Copyright (C) 2025 Kydra Project
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef LOCALARCHIVESEEDER_H
+#define LOCALARCHIVESEEDER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QStringList>
+#include <QTemporaryDir>
+
+#include <QApt/Globals>
+
+template <typename T> class QFutureWatcher;
+
+namespace QApt {
+    class Backend;
+    class Transaction;
+}
+
+/**
+ * Puts archives from the local .deb folders into APT's archive cache so
+ * that committing does not download them again.
+ *
+ * Packages marked for installation are matched against the local package
+ * index by name, candidate version and architecture; a match is only used
+ * when its SHA256 equals the one from the Packages index. Verified files
+ * are handed to the QApt worker as file: URIs of a download list, so the
+ * copy into the archive cache is done with the worker's privileges and
+ * checked against the hash once more by APT itself.
+ */
+class LocalArchiveSeeder : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LocalArchiveSeeder(QObject *parent = nullptr);
+
+    /// Emits finished() when done, also when there was nothing to seed
+    void seed(QApt::Backend *backend);
+
+Q_SIGNALS:
+    void finished(int archiveCount);
+
+private:
+    QApt::Backend *m_backend;
+    QTemporaryDir m_listDir;
+    QFutureWatcher<QStringList> *m_watcher;
+    QPointer<QApt::Transaction> m_trans;
+
+private Q_SLOTS:
+    void verified();
+    void transactionStatusChanged(QApt::TransactionStatus status);
+};
+
+#endif // LOCALARCHIVESEEDER_H
@@ -44,7 +44,7 @@ PackageIconExtractor* PackageIconExtractor::instance()
 
 PackageIconExtractor::PackageIconExtractor(QObject* parent)
     : QObject(parent)
-    , m_iconCache(100) // Cache up to 100 icons
+    , m_iconCache(1000) // Enough for the prefetch window of the package view
 {
 }
 
@@ -69,8 +69,13 @@ QIcon PackageIconExtractor::getPackageIcon(QApt::Package* package)
         }
     }
 
-    // Try to extract icon from package
-    QIcon packageIcon = extractIconFromPackage(package);
+    return packageIcon(package, desktopIconName(package->installedFilesList()));
+}
+
+QIcon PackageIconExtractor::packageIcon(QApt::Package* package, const QString& iconName)
+{
+    const QString packageName = package->name();
+    QIcon packageIcon = iconFromName(iconName);
     
     // If no specific icon found, fall back to appropriate KDE icons based on package type
     if (packageIcon.isNull()) {
@@ -110,38 +115,35 @@ QIcon PackageIconExtractor::getPackageIcon(QApt::Package* package)
     return packageIcon;
 }
 
+QIcon PackageIconExtractor::cachedPackageIcon(const QString& packageName)
+{
+    QMutexLocker locker(&m_cacheMutex);
+    QIcon *icon = m_iconCache.object(packageName);
+    return icon ? *icon : QIcon();
+}
+
 void PackageIconExtractor::clearCache()
 {
     QMutexLocker locker(&m_cacheMutex);
     m_iconCache.clear();
 }
 
-QIcon PackageIconExtractor::extractIconFromPackage(QApt::Package* package)
+QString PackageIconExtractor::desktopIconName(const QStringList& installedFiles)
 {
-    // First, try to get the icon from the package's desktop files
-    QStringList installedFiles = package->installedFilesList();
-    
     // Look for .desktop files in the installed files
     for (const QString& filePath : installedFiles) {
         if (filePath.endsWith(".desktop") && filePath.contains("/applications/")) {
             QFile desktopFile(filePath);
             if (desktopFile.open(QIODevice::ReadOnly | QIODevice::Text)) {
-                QString desktopContent = desktopFile.readAll();
-                desktopFile.close();
-                
-                QIcon icon = getIconFromDesktopFile(desktopContent);
-                if (!icon.isNull()) {
-                    return icon;
+                const QString iconName = iconNameFromDesktopFile(desktopFile.readAll());
+                if (!iconName.isEmpty()) {
+                    return iconName;
                 }
             }
         }
     }
 
-    // If no desktop file found, try to extract from the deb file if available
-    // This would require access to the original deb file, which might not be available
-    // for already installed packages
-    
-    return QIcon();
+    return QString();
 }
 
 QIcon PackageIconExtractor::extractIconFromDebFile(const QString& debFilePath)
@@ -198,17 +200,24 @@ QIcon PackageIconExtractor::extractIconFromDebFile(const QString& debFilePath)
 }
 
 QIcon PackageIconExtractor::getIconFromDesktopFile(const QString& desktopFileContent)
+{
+    return iconFromName(iconNameFromDesktopFile(desktopFileContent));
+}
+
+QString PackageIconExtractor::iconNameFromDesktopFile(const QString& desktopFileContent)
 {
     // Parse the desktop file to find the Icon field
-    QRegularExpression iconRegex("^Icon\\s*=\\s*(.+)$", QRegularExpression::MultilineOption);
-    QRegularExpressionMatch match = iconRegex.match(desktopFileContent);
-    
-    if (!match.hasMatch()) {
+    static const QRegularExpression iconRegex("^Icon\\s*=\\s*(.+)$", QRegularExpression::MultilineOption);
+    const QRegularExpressionMatch match = iconRegex.match(desktopFileContent);
+    return match.hasMatch() ? match.captured(1).trimmed() : QString();
+}
+
+QIcon PackageIconExtractor::iconFromName(const QString& iconName)
+{
+    if (iconName.isEmpty()) {
         return QIcon();
     }
 
-    QString iconName = match.captured(1).trimmed();
-    
     // If it's an absolute path, try to load it directly
     if (iconName.startsWith('/')) {
         if (QFile::exists(iconName)) {
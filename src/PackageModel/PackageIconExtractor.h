@@ -36,16 +36,24 @@ public:
     static PackageIconExtractor* instance();
     
     QIcon getPackageIcon(QApt::Package* package);
+    // Returns a null icon instead of extracting one when it is not cached
+    QIcon cachedPackageIcon(const QString& packageName);
+    // The Icon entry of the first application desktop file among
+    // installedFiles. Only reads files, so it may run on any thread.
+    static QString desktopIconName(const QStringList& installedFiles);
+    // Makes the icon of package from what desktopIconName() found, and caches it
+    QIcon packageIcon(QApt::Package* package, const QString& iconName);
     void clearCache();
 
 private:
     explicit PackageIconExtractor(QObject* parent = nullptr);
     ~PackageIconExtractor() override;
     
-    QIcon extractIconFromPackage(QApt::Package* package);
     QIcon extractIconFromDebFile(const QString& debFilePath);
     QIcon extractIconFromControlFile(const QString& controlData);
     QIcon getIconFromDesktopFile(const QString& desktopFileContent);
+    static QString iconNameFromDesktopFile(const QString& desktopFileContent);
+    QIcon iconFromName(const QString& iconName);
     QString findIconPath(const QString& iconName);
     
     QCache<QString, QIcon> m_iconCache;
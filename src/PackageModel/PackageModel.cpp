@@ -23,8 +23,10 @@
 #include "VirtualPackage.h"
 #include "LocalPackageManager.h"
 
+#include <QElapsedTimer>
 #include <QStringBuilder>
 #include <QIcon>
+#include <QTimer>
 #include <KLocalizedString>
 #include <KFormat>
 
@@ -32,7 +34,20 @@ PackageModel::PackageModel(QObject *parent)
     : QAbstractListModel(parent)
     , m_packages(QApt::PackageList())
     , m_virtualPackages(QList<VirtualPackage>())
+    , m_prefetchPosition(0)
+    , m_prefetchTimer(new QTimer(this))
+    , m_searchIndexTimer(new QTimer(this))
 {
+    // A zero interval timer fires whenever no other events are pending
+    m_prefetchTimer->setInterval(0);
+    connect(m_prefetchTimer, &QTimer::timeout, this, &PackageModel::prefetchChunk);
+
+    // Local scans add their packages in batches and Flatpak listings come
+    // right after each other; rank the search results again once for all
+    m_searchIndexTimer->setSingleShot(true);
+    m_searchIndexTimer->setInterval(200);
+    connect(m_searchIndexTimer, &QTimer::timeout, this, &PackageModel::searchIndexChanged);
+
     connect(LocalPackageManager::instance(), &LocalPackageManager::iconExtracted,
             this, &PackageModel::onIconExtracted);
             
@@ -41,6 +56,10 @@ PackageModel::PackageModel(QObject *parent)
             this, &PackageModel::onFlatpaksChanged);
 }
 
+PackageModel::~PackageModel()
+{
+}
+
 int PackageModel::rowCount(const QModelIndex & /*parent*/) const
 {
     return m_packages.size() + m_virtualPackages.size() + m_flatpakPackages.size();
@@ -63,6 +82,7 @@ QVariant PackageModel::data(const QModelIndex &index, int role) const
     if (row < m_packages.size()) {
         // APT package
         QApt::Package *package = m_packages.at(row);
+        RowCacheEntry cached;
         switch (role) {
         case NameRole:
             if (package->isForeignArch()) {
@@ -71,8 +91,14 @@ QVariant PackageModel::data(const QModelIndex &index, int role) const
             }
             return package->name();
         case IconRole:
+            if (cachedRow(row, &cached)) {
+                return cached.icon;
+            }
             return PackageIconExtractor::instance()->getPackageIcon(package);
         case DescriptionRole:
+            if (cachedRow(row, &cached)) {
+                return cached.description;
+            }
             return package->shortDescription();
         case StatusRole:
         case ActionRole:
@@ -82,6 +108,9 @@ QVariant PackageModel::data(const QModelIndex &index, int role) const
         case InstalledSizeRole:
             return package->installedSize();
         case InstalledSizeDisplayRole:
+            if (cachedRow(row, &cached)) {
+                return cached.installedSizeDisplay;
+            }
             {
                 qint64 size = package->installedSize();
                 if (size != -1) {
@@ -202,6 +231,7 @@ QVariant PackageModel::headerData(int section, Qt::Orientation orientation, int
 
 void PackageModel::setPackages(const QApt::PackageList &list)
 {
+    clearRowCache();
     beginResetModel();
     m_packages = list;
     endResetModel();
@@ -212,6 +242,10 @@ void PackageModel::setVirtualPackages(const QList<VirtualPackage> &virtualPackag
     beginResetModel();
     m_virtualPackages = virtualPackages;
     endResetModel();
+
+    m_searchIndex.clearLocalPackages();
+    m_searchIndex.addLocalPackages(virtualPackages);
+    m_searchIndexTimer->start();
 }
 
 void PackageModel::addVirtualPackages(const QList<VirtualPackage> &virtualPackages)
@@ -222,6 +256,9 @@ void PackageModel::addVirtualPackages(const QList<VirtualPackage> &virtualPackag
     beginInsertRows(QModelIndex(), currentTotal, currentTotal + newCount - 1);
     m_virtualPackages.append(virtualPackages);
     endInsertRows();
+
+    m_searchIndex.addLocalPackages(virtualPackages);
+    m_searchIndexTimer->start();
 }
 
 void PackageModel::clearVirtualPackages()
@@ -236,15 +273,23 @@ void PackageModel::clearVirtualPackages()
     beginRemoveRows(QModelIndex(), aptCount, aptCount + virtualCount - 1);
     m_virtualPackages.clear();
     endRemoveRows();
+
+    m_searchIndex.clearLocalPackages();
+    m_searchIndexTimer->start();
 }
 
 void PackageModel::clear()
 {
+    clearRowCache();
     beginRemoveRows(QModelIndex(), 0, m_packages.size() + m_virtualPackages.size() + m_flatpakPackages.size() - 1);
     m_packages.clear();
     m_virtualPackages.clear();
     m_flatpakPackages.clear();
     endRemoveRows();
+
+    m_searchIndex.clearLocalPackages();
+    m_searchIndex.setFlatpakPackages(QList<FlatpakPackage>());
+    m_searchIndexTimer->start();
 }
 
 void PackageModel::externalDataChanged()
@@ -288,11 +333,88 @@ QApt::PackageList PackageModel::packages() const
     return m_packages;
 }
 
+// Installing an application moves it from the available to the installed
+// ones, which the key makes a removal and an insertion
+static QString flatpakKey(const FlatpakPackage &pkg)
+{
+    return (pkg.isInstalled ? QLatin1Char('i') : QLatin1Char('a')) + pkg.id;
+}
+
+static bool sameFlatpakData(const FlatpakPackage &a, const FlatpakPackage &b)
+{
+    return a.name == b.name && a.description == b.description && a.version == b.version
+            && a.arch == b.arch && a.branch == b.branch && a.remote == b.remote
+            && a.downloadSize == b.downloadSize;
+}
+
 void PackageModel::setFlatpakPackages(const QList<FlatpakPackage> &flatpakPackages)
 {
-    beginResetModel();
-    m_flatpakPackages = flatpakPackages;
-    endResetModel();
+    // Updated in place with row notifications rather than a reset, so a
+    // single install keeps the selection and scroll position and the proxy
+    // only has to look at the rows that changed.
+    const int offset = m_packages.size() + m_virtualPackages.size();
+
+    QHash<QString, int> newRows;
+    newRows.reserve(flatpakPackages.size());
+    for (int i = 0; i < flatpakPackages.size(); ++i) {
+        newRows.insert(flatpakKey(flatpakPackages.at(i)), i);
+    }
+
+    // Drop rows that are gone, and rows that would have to move to keep
+    // the new order; they are inserted again below
+    QVector<bool> keep(m_flatpakPackages.size(), false);
+    int lastNewRow = -1;
+    for (int i = 0; i < m_flatpakPackages.size(); ++i) {
+        const int newRow = newRows.value(flatpakKey(m_flatpakPackages.at(i)), -1);
+        if (newRow > lastNewRow) {
+            keep[i] = true;
+            lastNewRow = newRow;
+        }
+    }
+    for (int last = m_flatpakPackages.size() - 1; last >= 0; --last) {
+        if (keep.at(last)) {
+            continue;
+        }
+        int first = last;
+        while (first > 0 && !keep.at(first - 1)) {
+            --first;
+        }
+        beginRemoveRows(QModelIndex(), offset + first, offset + last);
+        m_flatpakPackages.erase(m_flatpakPackages.begin() + first, m_flatpakPackages.begin() + last + 1);
+        endRemoveRows();
+        last = first;
+    }
+
+    // The remaining rows are in the new order, so walking both lists
+    // together tells new rows from changed ones
+    int row = 0;
+    while (row < flatpakPackages.size()) {
+        if (row < m_flatpakPackages.size()
+                && flatpakKey(m_flatpakPackages.at(row)) == flatpakKey(flatpakPackages.at(row))) {
+            if (!sameFlatpakData(m_flatpakPackages.at(row), flatpakPackages.at(row))) {
+                m_flatpakPackages[row] = flatpakPackages.at(row);
+                emit dataChanged(index(offset + row, 0), index(offset + row, columnCount() - 1));
+            }
+            ++row;
+            continue;
+        }
+
+        // Insert the run of new rows up to the next kept one
+        const QString nextKept = row < m_flatpakPackages.size() ? flatpakKey(m_flatpakPackages.at(row)) : QString();
+        int end = row;
+        while (end < flatpakPackages.size() && flatpakKey(flatpakPackages.at(end)) != nextKept) {
+            ++end;
+        }
+        beginInsertRows(QModelIndex(), offset + row, offset + end - 1);
+        for (int i = row; i < end; ++i) {
+            m_flatpakPackages.insert(i, flatpakPackages.at(i));
+        }
+        endInsertRows();
+        row = end;
+    }
+
+    m_searchIndex.setFlatpakPackages(m_flatpakPackages);
+    m_searchIndexTimer->start();
 }
 
 bool PackageModel::isFlatpakPackage(const QModelIndex &index) const
@@ -309,8 +431,32 @@ FlatpakPackage PackageModel::flatpakPackageAt(const QModelIndex &index) const
     return FlatpakPackage();
 }
 
+const SearchIndex &PackageModel::searchIndex() const
+{
+    return m_searchIndex;
+}
+
+SearchIndex::RowId PackageModel::searchRowId(const QModelIndex &index) const
+{
+    const int row = index.row();
+    if (row < 0) {
+        return 0;
+    } else if (row < m_packages.size()) {
+        return SearchIndex::aptRowId(m_packages.at(row));
+    } else if (row < m_packages.size() + m_virtualPackages.size()) {
+        return m_searchIndex.localRowId(m_virtualPackages.at(row - m_packages.size()).filename());
+    }
+
+    const int flatpakIdx = row - m_packages.size() - m_virtualPackages.size();
+    if (flatpakIdx < m_flatpakPackages.size()) {
+        return m_searchIndex.flatpakRowId(m_flatpakPackages.at(flatpakIdx).id);
+    }
+    return 0;
+}
+
 void PackageModel::onFlatpaksChanged()
 {
+    // A copy made on the GUI thread, where FlatpakManager updates its lists
     setFlatpakPackages(FlatpakManager::instance()->listPackages());
 }
 
@@ -327,4 +473,85 @@ void PackageModel::onIconExtracted(const QString &filePath, const QString & /*ic
     }
 }
 
+bool PackageModel::cachedRow(int row, RowCacheEntry *entry) const
+{
+    auto it = m_rowCache.constFind(row);
+    if (it == m_rowCache.constEnd()) {
+        return false;
+    }
+
+    *entry = it.value();
+    return true;
+}
+
+void PackageModel::prefetchRows(const QVector<int> &rows)
+{
+    // A newer viewport supersedes whatever was left of the previous one
+    m_prefetchQueue.clear();
+    m_prefetchPosition = 0;
+    for (int row : rows) {
+        if (row >= 0 && row < m_packages.size() && !m_rowCache.contains(row)) {
+            m_prefetchQueue.append(row);
+        }
+    }
+
+    if (m_prefetchQueue.isEmpty()) {
+        m_prefetchTimer->stop();
+    } else if (!m_prefetchTimer->isActive()) {
+        m_prefetchTimer->start();
+    }
+}
+
+void PackageModel::prefetchChunk()
+{
+    // Short enough not to delay input or painting noticeably
+    static const int s_chunkBudgetMs = 4;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    KFormat format;
+    while (m_prefetchPosition < m_prefetchQueue.size() && timer.elapsed() < s_chunkBudgetMs) {
+        const int row = m_prefetchQueue.at(m_prefetchPosition++);
+        if (row >= m_packages.size() || m_rowCache.contains(row)) {
+            continue;
+        }
+
+        QApt::Package *package = m_packages.at(row);
+        RowCacheEntry entry;
+        entry.icon = PackageIconExtractor::instance()->getPackageIcon(package);
+        entry.description = package->shortDescription();
+        const qint64 size = package->installedSize();
+        if (size != -1) {
+            entry.installedSizeDisplay = format.formatByteSize(size);
+        }
+        m_rowCache.insert(row, entry);
+    }
+
+    if (m_prefetchPosition >= m_prefetchQueue.size()) {
+        m_prefetchTimer->stop();
+        m_prefetchQueue.clear();
+        m_prefetchPosition = 0;
+    }
+}
+
+void PackageModel::retainRows(const QSet<int> &rows)
+{
+    auto it = m_rowCache.begin();
+    while (it != m_rowCache.end()) {
+        if (rows.contains(it.key())) {
+            ++it;
+        } else {
+            it = m_rowCache.erase(it);
+        }
+    }
+}
 
+void PackageModel::clearRowCache()
+{
+    // Drop any rows still queued before the package pointers they refer to go away
+    m_prefetchTimer->stop();
+    m_prefetchQueue.clear();
+    m_prefetchPosition = 0;
+    m_rowCache.clear();
+}
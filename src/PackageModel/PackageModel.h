@@ -22,11 +22,17 @@
 #define PACKAGEMODEL_H
 
 #include <QAbstractListModel>
+#include <QHash>
+#include <QIcon>
+#include <QSet>
 
 #include <QApt/Package>
 
 #include "VirtualPackage.h"
 #include "FlatpakManager.h"
+#include "SearchIndex.h"
+
+class QTimer;
 
 class PackageModel: public QAbstractListModel
 {
@@ -46,6 +52,7 @@ public:
         IsLocalRole = Qt::UserRole + 10
     };
     explicit PackageModel(QObject *parent = 0);
+    ~PackageModel();
 
     int rowCount(const QModelIndex &parent = QModelIndex()) const;
     int columnCount(const QModelIndex &parent = QModelIndex()) const;
@@ -68,10 +75,45 @@ public:
     bool isFlatpakPackage(const QModelIndex &index) const; // New method
     FlatpakPackage flatpakPackageAt(const QModelIndex &index) const; // New method
 
+    // Covers the local package files and Flatpaks currently in the model
+    const SearchIndex &searchIndex() const;
+    SearchIndex::RowId searchRowId(const QModelIndex &index) const;
+
+    // Row data prefetching. Rows are source rows of APT packages; other rows
+    // are cheap to compute and are ignored. Rows are filled in small chunks
+    // whenever the event loop is idle, as QApt and icon loading are GUI thread only.
+    void prefetchRows(const QVector<int> &rows);
+    void retainRows(const QSet<int> &rows);
+    void clearRowCache();
+
 private:
+    struct RowCacheEntry {
+        QIcon icon;
+        QString description;
+        QVariant installedSizeDisplay;
+    };
+
     QApt::PackageList m_packages;
     QList<VirtualPackage> m_virtualPackages;
     QList<FlatpakPackage> m_flatpakPackages; // New list
+    SearchIndex m_searchIndex;
+
+    QHash<int, RowCacheEntry> m_rowCache;
+    // Rows still to be filled, in order
+    QVector<int> m_prefetchQueue;
+    int m_prefetchPosition;
+    QTimer *m_prefetchTimer;
+    // Coalesces searchIndexChanged()
+    QTimer *m_searchIndexTimer;
+
+    bool cachedRow(int row, RowCacheEntry *entry) const;
+
+Q_SIGNALS:
+    // Local package files or Flatpaks were added to or removed from the search index
+    void searchIndexChanged();
+
+private Q_SLOTS:
+    void prefetchChunk();
 
 public slots:
     void externalDataChanged();
@@ -0,0 +1,154 @@
+/*
+ *  Viewport-driven row prefetching for Kydra Package Manager
+ *  Copyright (C) 2025 Kydra Project
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "PackagePrefetcher.h"
+
+// Qt includes
+#include <QScrollBar>
+#include <QSet>
+#include <QTimer>
+#include <QtMath>
+
+// Own includes
+#include "PackageModel.h"
+#include "PackageProxyModel.h"
+#include "PackageView.h"
+
+// Screens of rows to warm ahead of the viewport when idle and when flinging
+static const int s_lookaheadScreens = 2;
+static const int s_maxLookaheadScreens = 6;
+// Screens of rows behind the viewport worth keeping warm
+static const int s_lookbehindScreens = 1;
+// Cached rows further away than this many screens are evicted
+static const int s_retainScreens = 8;
+
+PackagePrefetcher::PackagePrefetcher(PackageView *view, PackageProxyModel *proxy,
+                                     PackageModel *model, QObject *parent)
+    : QObject(parent)
+    , m_view(view)
+    , m_proxy(proxy)
+    , m_model(model)
+    , m_timer(new QTimer(this))
+    , m_lastScrollValue(0)
+    , m_velocity(0)
+{
+    // Coalesce bursts of scroll and layout events into one prefetch pass
+    m_timer->setSingleShot(true);
+    m_timer->setInterval(30);
+    connect(m_timer, &QTimer::timeout, this, &PackagePrefetcher::prefetch);
+
+    connect(m_view->verticalScrollBar(), &QScrollBar::valueChanged,
+            this, &PackagePrefetcher::scrolled);
+    connect(m_proxy, &QAbstractItemModel::modelReset,
+            m_timer, QOverload<>::of(&QTimer::start));
+    connect(m_proxy, &QAbstractItemModel::layoutChanged,
+            m_timer, QOverload<>::of(&QTimer::start));
+    connect(m_proxy, &QAbstractItemModel::rowsInserted,
+            m_timer, QOverload<>::of(&QTimer::start));
+}
+
+void PackagePrefetcher::scrolled(int value)
+{
+    if (m_scrollClock.isValid()) {
+        const qint64 elapsed = qMax<qint64>(m_scrollClock.restart(), 1);
+        double delta = value - m_lastScrollValue;
+        if (m_view->verticalScrollMode() == QAbstractItemView::ScrollPerPixel) {
+            const int rowHeight = m_view->visualRect(m_view->indexAt(QPoint(0, 0))).height();
+            delta /= qMax(rowHeight, 1);
+        }
+        const double instant = delta * 1000.0 / elapsed;
+        // Smooth out jitter from wheel events
+        m_velocity = 0.7 * m_velocity + 0.3 * instant;
+    } else {
+        m_scrollClock.start();
+    }
+    m_lastScrollValue = value;
+
+    if (!m_timer->isActive()) {
+        m_timer->start();
+    }
+}
+
+void PackagePrefetcher::prefetch()
+{
+    const int rowCount = m_proxy->rowCount();
+    if (!rowCount) {
+        return;
+    }
+
+    const QModelIndex firstIndex = m_view->indexAt(QPoint(0, 0));
+    if (!firstIndex.isValid()) {
+        return;
+    }
+    const QModelIndex lastIndex = m_view->indexAt(QPoint(0, m_view->viewport()->height() - 1));
+
+    const int first = firstIndex.row();
+    const int last = lastIndex.isValid() ? lastIndex.row() : rowCount - 1;
+    const int page = last - first + 1;
+
+    // Velocity in screens per second decides how far ahead to look
+    const double screensPerSecond = qAbs(m_velocity) / page;
+    const int ahead = qBound(s_lookaheadScreens,
+                             s_lookaheadScreens + qCeil(screensPerSecond),
+                             s_maxLookaheadScreens) * page;
+    const int behind = s_lookbehindScreens * page;
+    const bool up = m_velocity < 0;
+
+    const int warmFirst = qMax(0, first - (up ? ahead : behind));
+    const int warmLast = qMin(rowCount - 1, last + (up ? behind : ahead));
+
+    // Visible rows first, then outward in the scroll direction
+    QVector<int> rows;
+    rows.reserve(warmLast - warmFirst + 1);
+    auto addRow = [this, &rows](int proxyRow) {
+        const QModelIndex source = m_proxy->mapToSource(m_proxy->index(proxyRow, 0));
+        if (source.isValid()) {
+            rows.append(source.row());
+        }
+    };
+    for (int row = first; row <= last; ++row) {
+        addRow(row);
+    }
+    if (up) {
+        for (int row = first - 1; row >= warmFirst; --row)
+            addRow(row);
+        for (int row = last + 1; row <= warmLast; ++row)
+            addRow(row);
+    } else {
+        for (int row = last + 1; row <= warmLast; ++row)
+            addRow(row);
+        for (int row = first - 1; row >= warmFirst; --row)
+            addRow(row);
+    }
+
+    // Evict whatever fell out of the retention window
+    const int retainFirst = qMax(0, first - s_retainScreens * page);
+    const int retainLast = qMin(rowCount - 1, last + s_retainScreens * page);
+    QSet<int> retained;
+    retained.reserve(retainLast - retainFirst + 1);
+    for (int row = retainFirst; row <= retainLast; ++row) {
+        const QModelIndex source = m_proxy->mapToSource(m_proxy->index(row, 0));
+        if (source.isValid()) {
+            retained.insert(source.row());
+        }
+    }
+
+    m_model->retainRows(retained);
+    m_model->prefetchRows(rows);
+}
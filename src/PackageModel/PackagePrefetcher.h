@@ -0,0 +1,64 @@
+/*
+ *  Viewport-driven row prefetching for Kydra Package Manager
+ *  Copyright (C) 2025 Kydra Project
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef PACKAGEPREFETCHER_H
+#define PACKAGEPREFETCHER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+
+class QTimer;
+
+class PackageModel;
+class PackageProxyModel;
+class PackageView;
+
+/**
+ * Watches the package view's viewport and warms the model's row cache for the
+ * rows that are about to scroll into view, so that painting them does not
+ * have to wait for QApt or the icon extractor. The model fills the cache
+ * while the event loop is idle.
+ *
+ * The lookahead grows with the scroll velocity and favours the direction of
+ * travel. Cached rows that drift far outside the viewport are evicted.
+ */
+class PackagePrefetcher : public QObject
+{
+    Q_OBJECT
+public:
+    PackagePrefetcher(PackageView *view, PackageProxyModel *proxy,
+                      PackageModel *model, QObject *parent = nullptr);
+
+private:
+    PackageView *m_view;
+    PackageProxyModel *m_proxy;
+    PackageModel *m_model;
+    QTimer *m_timer;
+
+    QElapsedTimer m_scrollClock;
+    int m_lastScrollValue;
+    // Rows per second, signed by scroll direction
+    double m_velocity;
+
+private Q_SLOTS:
+    void scrolled(int value);
+    void prefetch();
+};
+
+#endif // PACKAGEPREFETCHER_H
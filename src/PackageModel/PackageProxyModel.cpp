@@ -68,6 +68,13 @@ PackageProxyModel::PackageProxyModel(QObject *parent)
 {
 }
 
+void PackageProxyModel::setSourceModel(QAbstractItemModel *sourceModel)
+{
+    QSortFilterProxyModel::setSourceModel(sourceModel);
+    connect(static_cast<PackageModel *>(sourceModel), &PackageModel::searchIndexChanged,
+            this, &PackageProxyModel::searchIndexChanged);
+}
+
 void PackageProxyModel::setBackend(QApt::Backend *backend)
 {
     m_backend = backend;
@@ -85,6 +92,9 @@ void PackageProxyModel::search(const QString &searchText)
         if (m_searchPackages.isEmpty() && MuonSettings::self()->useSlowSearch()) {
             m_searchPackages = performSlowSearch(searchText);
         }
+
+        m_searchText = searchText;
+        m_searchRanking = static_cast<PackageModel *>(sourceModel())->searchIndex().search(searchText, m_searchPackages);
         
         if (!m_useSearchResults) {
             m_sortByRelevancy = true;
@@ -92,6 +102,8 @@ void PackageProxyModel::search(const QString &searchText)
         m_useSearchResults = true;
     } else {
         m_searchPackages.clear();
+        m_searchText.clear();
+        m_searchRanking.clear();
         m_packages =  static_cast<PackageModel *>(sourceModel())->packages();
         m_sortByRelevancy = false;
         m_useSearchResults = false;
@@ -100,6 +112,23 @@ void PackageProxyModel::search(const QString &searchText)
     invalidate();
 }
 
+void PackageProxyModel::searchIndexChanged()
+{
+    if (!m_useSearchResults) {
+        return;
+    }
+
+    // Local scans and Flatpak listings complete after the search started;
+    // the APT results stay valid, only the other rows need ranking again
+    m_searchRanking = static_cast<PackageModel *>(sourceModel())->searchIndex().search(m_searchText, m_searchPackages);
+    invalidate();
+}
+
+int PackageProxyModel::searchRank(const QModelIndex &sourceIndex) const
+{
+    return m_searchRanking.value(static_cast<PackageModel *>(sourceModel())->searchRowId(sourceIndex), -1);
+}
+
 void PackageProxyModel::setSortByRelevancy(bool enabled)
 {
     m_sortByRelevancy = enabled;
@@ -139,6 +168,37 @@ bool PackageProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourc
 {
     PackageModel *model = static_cast<PackageModel *>(sourceModel());
     QModelIndex index = model->index(sourceRow, 0, sourceParent);
+
+    // Handle Flatpaks
+    if (model->isFlatpakPackage(index)) {
+        const FlatpakPackage fPkg = model->flatpakPackageAt(index);
+
+        if (!m_groupFilter.isEmpty() && !fPkg.section.contains(m_groupFilter)) {
+            return false;
+        }
+
+        if (m_stateFilter != 0) {
+            const QApt::Package::State state = fPkg.isInstalled ? QApt::Package::Installed
+                                                                 : QApt::Package::NotInstalled;
+            if (!(m_stateFilter & state)) {
+                return false;
+            }
+        }
+
+        if (!m_originFilter.isEmpty() && fPkg.remote != m_originFilter) {
+            return false;
+        }
+
+        if (!m_archFilter.isEmpty() && fPkg.arch != m_archFilter) {
+            return false;
+        }
+
+        if (m_useSearchResults) {
+            return m_searchRanking.contains(model->searchRowId(index));
+        }
+
+        return true;
+    }
     
     // Handle Virtual Packages
     if (model->isVirtualPackage(index)) {
@@ -178,14 +238,8 @@ bool PackageProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourc
             }
         }
         
-        // Search filtering for virtual packages
         if (m_useSearchResults) {
-            // Basic search implementation for virtual packages
-            // Since m_searchPackages only contains QApt::Package*, we can't use it directly.
-            // We rely on the fact that if we are using search results, we probably shouldn't show virtual packages
-            // UNLESS we implement search for them too.
-            // For now, let's hide them if search is active, OR implement a simple check.
-            return false; // TODO: Implement search for virtual packages
+            return m_searchRanking.contains(model->searchRowId(index));
         }
 
         return true;
@@ -251,7 +305,7 @@ bool PackageProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourc
     }
 
     if (m_useSearchResults)
-        return m_searchPackages.contains(package);
+        return m_searchRanking.contains(SearchIndex::aptRowId(package));
 
     return true;
 }
@@ -299,6 +353,11 @@ void PackageProxyModel::reset()
 bool PackageProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
 {
     PackageModel *model = static_cast<PackageModel *>(sourceModel());
+
+    if (m_sortByRelevancy && left.column() == 0) {
+        // Ranked together whatever the source
+        return searchRank(left) > searchRank(right);
+    }
     
     bool leftIsVirtual = model->isVirtualPackage(left);
     bool rightIsVirtual = model->isVirtualPackage(right);
@@ -339,12 +398,7 @@ bool PackageProxyModel::lessThan(const QModelIndex &left, const QModelIndex &rig
 
     switch (left.column()) {
       case 0:
-          if (m_sortByRelevancy) {
-              // This is expensive for very large datasets. It takes about 3 seconds with 30,000 packages
-              // The order in m_packages is based on relevancy when returned by m_backend->search()
-              // Use this order to determine less than
-              return (m_searchPackages.indexOf(leftPackage) > m_searchPackages.indexOf(rightPackage));
-          } else {
+          {
               QString leftString = left.data(PackageModel::NameRole).toString();
               QString rightString = right.data(PackageModel::NameRole).toString();
 
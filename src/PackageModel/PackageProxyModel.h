@@ -27,6 +27,7 @@
 #include <QApt/Package>
 #include "VirtualPackage.h"
 #include "FlatpakManager.h"
+#include "SearchIndex.h"
 
 namespace QApt {
     class Backend;
@@ -38,6 +39,7 @@ class PackageProxyModel : public QSortFilterProxyModel
 public:
     PackageProxyModel(QObject *parent);
 
+    void setSourceModel(QAbstractItemModel *sourceModel) override;
     void setBackend(QApt::Backend *backend);
     void search(const QString &searchText);
     void setSortByRelevancy(bool enabled);
@@ -65,6 +67,8 @@ private:
     QApt::Backend *m_backend;
     QApt::PackageList m_packages;
     QApt::PackageList m_searchPackages;
+    // Rank of every row matching the search, across all sources
+    SearchIndex::Ranking m_searchRanking;
 
     QString m_searchText;
     QString m_groupFilter;
@@ -74,6 +78,11 @@ private:
 
     bool m_sortByRelevancy;
     bool m_useSearchResults;
+
+    int searchRank(const QModelIndex &sourceIndex) const;
+
+private Q_SLOTS:
+    void searchIndexChanged();
 };
 
 #endif
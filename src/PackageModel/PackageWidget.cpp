@@ -50,6 +50,9 @@
 #include "VirtualPackage.h"
 #include "FlatpakManager.h"
 #include "muonapt/ChangesDialog.h"
+#include "muonapt/MarkingBatch.h"
+#include "muonapt/MarkingJournal.h"
+#include "muonapt/QAptActions.h"
 #include "DetailsWidget.h"
 #include "EnhancedDetailsWidget.h"
 #include "MuonSettings.h"
@@ -57,6 +60,7 @@
 #include "PackageProxyModel.h"
 #include "PackageView.h"
 #include "PackageDelegate.h"
+#include "PackagePrefetcher.h"
 
 bool packageNameLessThan(QApt::Package *p1, QApt::Package *p2)
 {
@@ -75,7 +79,6 @@ PackageWidget::PackageWidget(QWidget *parent)
         , m_headerLabel(0)
         , m_searchEdit(0)
         , m_packagesType(0)
-        , m_stop(false)
 {
     m_watcher = new QFutureWatcher<QList<QApt::Package*> >(this);
     connect(m_watcher, &QFutureWatcher<QList<QApt::Package*> >::finished, this, &PackageWidget::setSortedPackages);
@@ -124,6 +127,8 @@ PackageWidget::PackageWidget(QWidget *parent)
     }
     topVBox->addWidget(m_packageView);
 
+    new PackagePrefetcher(m_packageView, m_proxyModel, m_model, this);
+
     m_detailsWidget = new EnhancedDetailsWidget;
     connect(m_detailsWidget, SIGNAL(setInstall(QApt::Package*)),
             this, SLOT(setInstall(QApt::Package*)));
@@ -490,8 +495,9 @@ bool PackageWidget::confirmEssentialRemoval()
 void PackageWidget::saveState()
 {
     if (!m_backend->areEventsCompressed()) {
-        m_oldCacheState = m_backend->currentCacheState();
-        m_backend->saveCacheState();
+        MarkingJournal *journal = QAptActions::self()->journal();
+        journal->checkpoint();
+        m_oldCacheState = journal->checkpointState();
     }
 }
 
@@ -500,7 +506,6 @@ void PackageWidget::handleBreakage(QApt::Package *package)
     if (package->wouldBreak() || m_backend->isBroken()) {
         showBrokenReason(package);
         m_backend->restoreCacheState(m_oldCacheState);
-        m_stop = true;
     }
 }
 
@@ -508,46 +513,6 @@ void PackageWidget::actOnPackages(QApt::Package::State action)
 {
     const QApt::PackageList packages = selectedPackages();
 
-    if (packages.isEmpty())
-        return;
-
-    QApplication::setOverrideCursor(Qt::WaitCursor);
-    saveState();
-    m_backend->setCompressEvents(true);
-    m_stop = false;
-
-    for (QApt::Package *package : packages) {
-        if (m_stop) {
-            m_backend->setCompressEvents(false);
-            QApplication::restoreOverrideCursor();
-            break;
-        }
-
-        switch (action) {
-        case QApt::Package::ToInstall:
-            setInstall(package);
-            break;
-        case QApt::Package::ToRemove:
-            setRemove(package);
-            break;
-        case QApt::Package::ToUpgrade:
-            setUpgrade(package);
-            break;
-        case QApt::Package::ToReInstall:
-            if (package->isInstalled())
-                setReInstall(package);
-            break;
-        case QApt::Package::ToKeep:
-            setKeep(package);
-            break;
-        case QApt::Package::ToPurge:
-            setPurge(package);
-            break;
-        default:
-            break;
-        }
-    }
-    
     // Handle Virtual Packages separately
     // Note: selectedPackages() currently only returns QApt::Package*. 
     // We need to update selectedPackages() or handle virtual packages differently.
@@ -566,12 +531,64 @@ void PackageWidget::actOnPackages(QApt::Package::State action)
         }
     }
 
-    emit packageChanged();
+    if (packages.isEmpty())
+        return;
+
+    // Ask about essential packages once for the whole selection
+    bool removeImportant = true;
+    if (action == QApt::Package::ToRemove || action == QApt::Package::ToPurge) {
+        for (QApt::Package *package : packages) {
+            if (package->state() & QApt::Package::IsImportant) {
+                removeImportant = confirmEssentialRemoval();
+                break;
+            }
+        }
+    }
 
-    m_backend->setCompressEvents(false);
+    MarkingBatch batch(m_backend);
+    for (QApt::Package *package : packages) {
+        if (!removeImportant && (package->state() & QApt::Package::IsImportant)) {
+            continue;
+        }
+        batch.add(package, action);
+    }
+
+    if (batch.isEmpty())
+        return;
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    batch.apply();
+    m_oldCacheState = batch.savedState();
     QApplication::restoreOverrideCursor();
 
-    checkChanges();
+    emit packageChanged();
+
+    reviewBatch(batch);
+}
+
+void PackageWidget::reviewBatch(MarkingBatch &batch)
+{
+    QMap<QString, QString> failures;
+    for (const MarkingBatch::Failure &failure : batch.failures()) {
+        QString reasons;
+        for (const QApt::MarkingErrorInfo &reason : failure.reasons)
+            reasons += digestReason(failure.package, reason);
+        failures.insert(failure.package->name(), reasons);
+    }
+
+    QApt::StateChanges changes;
+    if (MuonSettings::self()->askChanges()) {
+        changes = m_backend->stateChanges(batch.savedState(), batch.packages());
+    }
+
+    if (changes.isEmpty() && failures.isEmpty())
+        return;
+
+    ChangesDialog dialog(this, changes, failures);
+    int res = dialog.exec();
+
+    if (res != QDialog::Accepted && !changes.isEmpty())
+        batch.revert();
 }
 
 void PackageWidget::setInstall(QApt::Package *package)
@@ -37,6 +37,7 @@ class KPixmapSequenceOverlayPainter;
 
 class DetailsWidget;
 class EnhancedDetailsWidget;
+class MarkingBatch;
 class PackageModel;
 class PackageProxyModel;
 class PackageView;
@@ -96,9 +97,10 @@ private:
     QAction *m_lockAction;
 
     int m_packagesType;
-    bool m_stop;
 
     void checkChanges();
+    // Asks about the additional changes of a batch and lists what failed
+    void reviewBatch(MarkingBatch &batch);
     QApt::PackageList selectedPackages();
     QString digestReason(QApt::Package *pkg,
                          const QApt::MarkingErrorInfo &info);
@@ -0,0 +1,154 @@
+/*
+ *  Package search index for Kydra Package Manager
+ *  Copyright (C) 2025 Kydra Project
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "SearchIndex.h"
+
+#include <algorithm>
+
+// How well a name and summary match, lower is better; -1 if they do not
+static int matchTier(const QString &name, const QString &summary, const QString &text)
+{
+    if (name == text) {
+        return 0;
+    }
+    if (name.startsWith(text)) {
+        return 1;
+    }
+    if (name.contains(text)) {
+        return 2;
+    }
+    if (summary.contains(text)) {
+        return 3;
+    }
+    return -1;
+}
+
+static SearchIndex::Source sourceOf(SearchIndex::RowId id)
+{
+    return static_cast<SearchIndex::Source>(id >> 32);
+}
+
+SearchIndex::SearchIndex()
+    : m_nextId(1)
+{
+}
+
+SearchIndex::RowId SearchIndex::aptRowId(QApt::Package *package)
+{
+    return (RowId(AptSource) << 32) | quint32(package->id());
+}
+
+SearchIndex::RowId SearchIndex::localRowId(const QString &filename) const
+{
+    return m_localIds.value(filename);
+}
+
+SearchIndex::RowId SearchIndex::flatpakRowId(const QString &id) const
+{
+    return m_flatpakIds.value(id);
+}
+
+SearchIndex::RowId SearchIndex::addEntry(Source source, const QString &name, const QString &otherName,
+                                        const QString &summary)
+{
+    Entry entry;
+    entry.id = (RowId(source) << 32) | m_nextId++;
+    entry.name = name.toLower();
+    entry.otherName = otherName.toLower();
+    entry.summary = summary.toLower();
+    m_entries.append(entry);
+    return entry.id;
+}
+
+void SearchIndex::removeEntries(Source source)
+{
+    m_entries.erase(std::remove_if(m_entries.begin(), m_entries.end(), [source](const Entry &entry) {
+        return sourceOf(entry.id) == source;
+    }), m_entries.end());
+}
+
+void SearchIndex::addLocalPackages(const QList<VirtualPackage> &packages)
+{
+    for (const VirtualPackage &pkg : packages) {
+        if (!m_localIds.contains(pkg.filename())) {
+            m_localIds.insert(pkg.filename(), addEntry(LocalSource, pkg.name(), QString(), pkg.shortDescription()));
+        }
+    }
+}
+
+void SearchIndex::clearLocalPackages()
+{
+    m_localIds.clear();
+    removeEntries(LocalSource);
+}
+
+void SearchIndex::setFlatpakPackages(const QList<FlatpakPackage> &packages)
+{
+    m_flatpakIds.clear();
+    removeEntries(FlatpakSource);
+
+    for (const FlatpakPackage &pkg : packages) {
+        m_flatpakIds.insert(pkg.id, addEntry(FlatpakSource, pkg.name, pkg.id, pkg.description));
+    }
+}
+
+SearchIndex::Ranking SearchIndex::search(const QString &text, const QApt::PackageList &aptResults) const
+{
+    struct Match {
+        RowId id;
+        int tier;
+    };
+
+    const QString needle = text.toLower();
+    QList<Match> matches;
+    matches.reserve(aptResults.size());
+
+    // Xapian already ranked these; only a name match moves a result up.
+    // Reading summaries here would parse a package record per result, and
+    // Debian package names are lower case already.
+    for (QApt::Package *package : aptResults) {
+        const int tier = matchTier(package->name(), QString(), needle);
+        matches.append({ aptRowId(package), tier == -1 ? 3 : tier });
+    }
+
+    for (const Entry &entry : m_entries) {
+        int tier = matchTier(entry.name, entry.summary, needle);
+        if (!entry.otherName.isEmpty()) {
+            const int otherTier = matchTier(entry.otherName, entry.summary, needle);
+            if (tier == -1 || (otherTier != -1 && otherTier < tier)) {
+                tier = otherTier;
+            }
+        }
+        if (tier != -1) {
+            matches.append({ entry.id, tier });
+        }
+    }
+
+    // Stable, so APT results keep Xapian's order within a tier
+    std::stable_sort(matches.begin(), matches.end(), [](const Match &a, const Match &b) {
+        return a.tier < b.tier;
+    });
+
+    Ranking ranking;
+    ranking.reserve(matches.size());
+    for (int i = 0; i < matches.size(); ++i) {
+        ranking.insert(matches.at(i).id, i);
+    }
+    return ranking;
+}
@@ -0,0 +1,93 @@
+/*
+ *  Package search index for Kydra Package Manager
+ *  Copyright (C) 2025 Kydra Project
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef SEARCHINDEX_H
+#define SEARCHINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+
+#include <QApt/Package>
+
+#include "FlatpakManager.h"
+#include "VirtualPackage.h"
+
+/**
+ * Searches the rows of the package list whatever their source.
+ *
+ * APT packages are found through QApt's Xapian search; the index only
+ * ranks what that returns. Local package files and Flatpaks are indexed
+ * here, as they are scanned and listed, so searching them costs no more
+ * than a pass over a few thousand short strings.
+ *
+ * Every row has a RowId: the cache id of an APT package, or an id the
+ * index hands out to a local file or Flatpak when it is added.
+ */
+class SearchIndex
+{
+public:
+    enum Source {
+        AptSource = 0,
+        LocalSource,
+        FlatpakSource
+    };
+
+    typedef quint64 RowId;
+    /// Search result rank by row, 0 being the best match
+    typedef QHash<RowId, int> Ranking;
+
+    SearchIndex();
+
+    static RowId aptRowId(QApt::Package *package);
+    /// @returns 0 for files and applications that are not indexed
+    RowId localRowId(const QString &filename) const;
+    RowId flatpakRowId(const QString &id) const;
+
+    void addLocalPackages(const QList<VirtualPackage> &packages);
+    void clearLocalPackages();
+    void setFlatpakPackages(const QList<FlatpakPackage> &packages);
+
+    /**
+     * Ranks the local files and Flatpaks matching @p text together with
+     * @p aptResults, the APT packages Xapian found in its order of relevance.
+     * Matches on the name rank before matches on the summary alone; APT
+     * results are only checked by name and otherwise keep Xapian's order.
+     */
+    Ranking search(const QString &text, const QApt::PackageList &aptResults) const;
+
+private:
+    struct Entry {
+        RowId id;
+        // Lower case; a Flatpak's application id is its other name
+        QString name;
+        QString otherName;
+        QString summary;
+    };
+
+    QHash<QString, RowId> m_localIds;
+    QHash<QString, RowId> m_flatpakIds;
+    QList<Entry> m_entries;
+    quint32 m_nextId;
+
+    RowId addEntry(Source source, const QString &name, const QString &otherName, const QString &summary);
+    void removeEntries(Source source);
+};
+
+#endif // SEARCHINDEX_H
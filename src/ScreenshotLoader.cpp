@@ -0,0 +1,245 @@
+/*
+ *  Screenshot loading for Kydra Package Manager
+ *  Copyright (C) 2025 Kydra Project
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "ScreenshotLoader.h"
+
+// Qt includes
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QImageReader>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrent>
+
+// KDE includes
+#include <KIO/StoredTransferJob>
+
+// Trim the store back under these limits, least recently used first
+static const qint64 s_maximumObjectsSize = 64 * 1024 * 1024;
+static const int s_maximumUrlCount = 4096;
+
+static QString storeDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+            + QLatin1String("/screenshots");
+}
+
+static QString urlIndexPath(const QUrl &url)
+{
+    const QByteArray key = QCryptographicHash::hash(url.toEncoded(), QCryptographicHash::Sha1).toHex();
+    return storeDirectory() + QLatin1String("/urls/") + QString::fromLatin1(key);
+}
+
+static QString objectPath(const QByteArray &hash)
+{
+    return storeDirectory() + QLatin1String("/objects/") + QString::fromLatin1(hash);
+}
+
+// The modification time doubles as the last access time for eviction.
+// Only works on an open file.
+static void touch(QFile *file)
+{
+    file->setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+}
+
+static void trimStore()
+{
+    QDir objects(storeDirectory() + QLatin1String("/objects"));
+    qint64 total = 0;
+    for (const QFileInfo &entry : objects.entryInfoList(QDir::Files, QDir::Time)) {
+        total += entry.size();
+        if (total > s_maximumObjectsSize) {
+            QFile::remove(entry.absoluteFilePath());
+        }
+    }
+
+    // Entries whose object went are dropped on their next lookup anyway,
+    // this only bounds how many there are
+    QDir urls(storeDirectory() + QLatin1String("/urls"));
+    const QFileInfoList entries = urls.entryInfoList(QDir::Files, QDir::Time);
+    for (int i = s_maximumUrlCount; i < entries.size(); ++i) {
+        QFile::remove(entries.at(i).absoluteFilePath());
+    }
+}
+
+static QImage scaledImage(QIODevice *device, const QSize &size)
+{
+    QImageReader reader(device);
+    // Let the decoder scale (JPEG can decode at reduced size directly)
+    const QSize imageSize = reader.size();
+    if (imageSize.isValid()) {
+        reader.setScaledSize(imageSize.scaled(size, Qt::KeepAspectRatio));
+    }
+
+    QImage image = reader.read();
+    if (image.isNull()) {
+        return image;
+    }
+    if (image.width() > size.width() || image.height() > size.height()) {
+        image = image.scaled(size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    return image;
+}
+
+// Looks the URL up in the store; a null image means it has to be fetched
+static QImage loadFromStore(const QUrl &url, const QSize &size)
+{
+    QFile index(urlIndexPath(url));
+    if (!index.open(QIODevice::ReadOnly)) {
+        return QImage();
+    }
+
+    QFile object(objectPath(index.readAll().trimmed()));
+    if (!object.open(QIODevice::ReadOnly)) {
+        // Evicted
+        index.close();
+        QFile::remove(index.fileName());
+        return QImage();
+    }
+    touch(&index);
+    touch(&object);
+    return scaledImage(&object, size);
+}
+
+static void addToStore(const QUrl &url, const QByteArray &data)
+{
+    const QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Sha256).toHex();
+    QDir().mkpath(storeDirectory() + QLatin1String("/objects"));
+    QDir().mkpath(storeDirectory() + QLatin1String("/urls"));
+
+    // Identical images from different URLs are stored once
+    if (!QFile::exists(objectPath(hash))) {
+        QSaveFile object(objectPath(hash));
+        if (!object.open(QIODevice::WriteOnly)) {
+            return;
+        }
+        object.write(data);
+        if (!object.commit()) {
+            return;
+        }
+    } else {
+        QFile object(objectPath(hash));
+        if (object.open(QIODevice::ReadOnly)) {
+            touch(&object);
+        }
+    }
+
+    QSaveFile index(urlIndexPath(url));
+    if (index.open(QIODevice::WriteOnly)) {
+        index.write(hash);
+        index.commit();
+    }
+
+    trimStore();
+}
+
+ScreenshotLoader::ScreenshotLoader(const QSize &thumbnailSize, QObject *parent)
+    : QObject(parent)
+    , m_thumbnailSize(thumbnailSize)
+    , m_generation(0)
+{
+}
+
+void ScreenshotLoader::load(const QUrl &url)
+{
+    cancel();
+    const quint64 generation = m_generation;
+
+    const QSize size = m_thumbnailSize;
+    auto *watcher = new QFutureWatcher<QImage>(this);
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, url, generation]() {
+        const QImage thumbnail = watcher->result();
+        watcher->deleteLater();
+
+        if (generation != m_generation) {
+            return;
+        }
+        if (thumbnail.isNull()) {
+            download(url, generation);
+        } else {
+            finish(url, thumbnail, generation);
+        }
+    });
+    watcher->setFuture(QtConcurrent::run(loadFromStore, url, size));
+}
+
+void ScreenshotLoader::cancel()
+{
+    ++m_generation;
+    if (m_job) {
+        m_job->kill(KJob::Quietly);
+    }
+}
+
+void ScreenshotLoader::download(const QUrl &url, quint64 generation)
+{
+    m_job = KIO::storedGet(url, KIO::NoReload, KIO::HideProgressInfo);
+    KIO::StoredTransferJob *job = m_job;
+    connect(job, &KJob::result, this, [this, job, url, generation]() {
+        if (generation != m_generation) {
+            return;
+        }
+        if (job->error()) {
+            qDebug() << "Could not fetch screenshot" << url << job->errorString();
+            emit failed(url);
+            return;
+        }
+        decode(url, job->data(), generation);
+    });
+}
+
+void ScreenshotLoader::decode(const QUrl &url, const QByteArray &data, quint64 generation)
+{
+    const QSize size = m_thumbnailSize;
+    auto *watcher = new QFutureWatcher<QImage>(this);
+    connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, url, generation]() {
+        const QImage thumbnail = watcher->result();
+        watcher->deleteLater();
+        finish(url, thumbnail, generation);
+    });
+    watcher->setFuture(QtConcurrent::run([url, data, size]() {
+        QBuffer buffer;
+        buffer.setData(data);
+        buffer.open(QIODevice::ReadOnly);
+        const QImage thumbnail = scaledImage(&buffer, size);
+        // Only keep what decodes, so the store never serves broken files
+        if (!thumbnail.isNull()) {
+            addToStore(url, data);
+        }
+        return thumbnail;
+    }));
+}
+
+void ScreenshotLoader::finish(const QUrl &url, const QImage &thumbnail, quint64 generation)
+{
+    if (generation != m_generation) {
+        return;
+    }
+
+    if (thumbnail.isNull()) {
+        emit failed(url);
+    } else {
+        emit loaded(url, thumbnail);
+    }
+}
@@ -0,0 +1,66 @@
+/*
+ *  Screenshot loading for Kydra Package Manager
+ *  Copyright (C) 2025 Kydra Project
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef SCREENSHOTLOADER_H
+#define SCREENSHOTLOADER_H
+
+#include <QObject>
+#include <QImage>
+#include <QPointer>
+#include <QSize>
+#include <QUrl>
+
+namespace KIO {
+    class StoredTransferJob;
+}
+
+/**
+ * Loads screenshots as thumbnails without blocking the GUI thread.
+ *
+ * Images are fetched through KIO, so any URL KIO understands works,
+ * file:// included. Downloaded bytes are kept in a content-addressed disk
+ * store (objects named by their SHA-256, plus a URL index), and decoding and
+ * downscaling happen on a worker thread. Only the latest request is served:
+ * starting a new one, or calling cancel(), abandons the previous one.
+ */
+class ScreenshotLoader : public QObject
+{
+    Q_OBJECT
+public:
+    explicit ScreenshotLoader(const QSize &thumbnailSize, QObject *parent = nullptr);
+
+    void load(const QUrl &url);
+    void cancel();
+
+Q_SIGNALS:
+    void loaded(const QUrl &url, const QImage &thumbnail);
+    void failed(const QUrl &url);
+
+private:
+    QSize m_thumbnailSize;
+    QPointer<KIO::StoredTransferJob> m_job;
+    // Identifies the current request; stale results are dropped
+    quint64 m_generation;
+
+    void download(const QUrl &url, quint64 generation);
+    void decode(const QUrl &url, const QByteArray &data, quint64 generation);
+    void finish(const QUrl &url, const QImage &thumbnail, quint64 generation);
+};
+
+#endif // SCREENSHOTLOADER_H
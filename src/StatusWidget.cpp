@@ -34,6 +34,9 @@
 // QApt includes
 #include <QApt/Backend>
 
+// Own includes
+#include "muonapt/TransactionTimingModel.h"
+
 StatusWidget::StatusWidget(QWidget *parent)
     : QWidget(parent)
     , m_backend(0)
@@ -79,6 +82,8 @@ void StatusWidget::setBackend(QApt::Backend *backend)
             this, SLOT(showXapianProgress()));
     connect(m_backend, SIGNAL(xapianUpdateProgress(int)),
             this, SLOT(updateXapianProgress(int)));
+    connect(TransactionTimingModel::instance(), SIGNAL(updated()),
+            this, SLOT(updateStatus()));
     updateStatus();
 }
 
@@ -124,16 +129,25 @@ void StatusWidget::updateStatus()
                                toInstallOrUpgradeText % toRemoveText);
 
         qint64 installSize = m_backend->installSize();
+        QString sizeText;
         if (installSize < 0) {
             installSize = -installSize;
-            m_downloadLabel->setText(i18nc("@label showing download and install size", "%1 to download, %2 of space to be freed",
-                                           KFormat().formatByteSize(m_backend->downloadSize()),
-                                           KFormat().formatByteSize(installSize)));
+            sizeText = i18nc("@label showing download and install size", "%1 to download, %2 of space to be freed",
+                             KFormat().formatByteSize(m_backend->downloadSize()),
+                             KFormat().formatByteSize(installSize));
         } else {
-            m_downloadLabel->setText(i18nc("@label showing download and install size", "%1 to download, %2 of space to be used",
-                                           KFormat().formatByteSize(m_backend->downloadSize()),
-                                           KFormat().formatByteSize(installSize)));
+            sizeText = i18nc("@label showing download and install size", "%1 to download, %2 of space to be used",
+                             KFormat().formatByteSize(m_backend->downloadSize()),
+                             KFormat().formatByteSize(installSize));
+        }
+
+        const qint64 duration = TransactionTimingModel::instance()->estimate(m_backend->markedPackages());
+        if (duration > 0) {
+            sizeText += i18nc("@label Part of the download label, time applying the changes is expected to take",
+                              ", about %1 to apply",
+                              KFormat().formatSpelloutDuration(quint64(duration) * 1000));
         }
+        m_downloadLabel->setText(sizeText);
 
         m_downloadLabel->show();
     } else {
@@ -0,0 +1,567 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "TransactionQueue.h"
+
+// Qt includes
+#include <QDebug>
+#include <QIcon>
+#include <QStringBuilder>
+
+// KDE includes
+#include <KLocalizedString>
+
+// QApt includes
+#include <QApt/Backend>
+#include <QApt/DebFile>
+#include <QApt/Transaction>
+
+// Own includes
+#include "muonapt/MarkingBatch.h"
+#include "muonapt/MarkingJournal.h"
+#include "muonapt/QAptActions.h"
+#include "muonapt/TransactionTimingModel.h"
+#include "PackageModel/FlatpakManager.h"
+#include "PackageModel/LocalArchiveSeeder.h"
+
+TransactionQueue *TransactionQueue::s_instance = nullptr;
+
+TransactionQueue *TransactionQueue::instance()
+{
+    if (!s_instance) {
+        s_instance = new TransactionQueue();
+    }
+    return s_instance;
+}
+
+TransactionQueue::TransactionQueue(QObject *parent)
+    : QAbstractListModel(parent)
+    , m_backend(nullptr)
+    , m_nextId(1)
+    , m_aptItemId(0)
+    , m_flatpakItemId(0)
+    , m_aptItemSeeding(false)
+    , m_flatpakOperationId(0)
+    , m_flatpakCancelRequested(false)
+{
+    m_seeder = new LocalArchiveSeeder(this);
+    connect(FlatpakManager::instance(), &FlatpakManager::operationProgress,
+            this, [this](quint64 operationId, int percent) {
+        flatpakOperationProgress(operationId, percent);
+    });
+    connect(FlatpakManager::instance(), &FlatpakManager::operationFinished,
+            this, [this](quint64 operationId, const QString &, bool success) {
+        flatpakOperationFinished(operationId, success);
+    });
+}
+
+void TransactionQueue::setBackend(QApt::Backend *backend)
+{
+    m_backend = backend;
+}
+
+int TransactionQueue::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_items.size();
+}
+
+QVariant TransactionQueue::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_items.size()) {
+        return QVariant();
+    }
+
+    const Item &item = m_items.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+        return i18nc("@item queue entry: what it does (its state)", "%1 (%2)",
+                     item.title, stateText(item));
+    case Qt::DecorationRole:
+        switch (item.state) {
+        case QueuedState:
+            return QIcon::fromTheme("chronometer");
+        case DownloadingState:
+            return QIcon::fromTheme("download");
+        case RunningState:
+            return QIcon::fromTheme("system-run");
+        case FinishedState:
+            return QIcon::fromTheme("dialog-ok-apply");
+        case FailedState:
+            return QIcon::fromTheme("dialog-error");
+        case CancelledState:
+            return QIcon::fromTheme("dialog-cancel");
+        }
+        break;
+    case KindRole:
+        return item.kind;
+    case StateRole:
+        return item.state;
+    case ProgressRole:
+        return item.progress;
+    default:
+        break;
+    }
+
+    return QVariant();
+}
+
+QString TransactionQueue::stateText(const Item &item) const
+{
+    switch (item.state) {
+    case QueuedState:
+        return i18nc("@item:intext queue state", "queued");
+    case DownloadingState:
+        return i18nc("@item:intext queue state", "downloading, %1%", item.progress);
+    case RunningState:
+        if (item.progress > 0 && item.progress <= 100) {
+            return i18nc("@item:intext queue state", "running, %1%", item.progress);
+        }
+        return i18nc("@item:intext queue state", "running");
+    case FinishedState:
+        return i18nc("@item:intext queue state", "done");
+    case FailedState:
+        return i18nc("@item:intext queue state", "failed");
+    case CancelledState:
+        return i18nc("@item:intext queue state", "cancelled");
+    }
+    return QString();
+}
+
+int TransactionQueue::rowOf(quint64 id) const
+{
+    for (int i = 0; i < m_items.size(); ++i) {
+        if (m_items.at(i).id == id) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+bool TransactionQueue::isAptKind(ItemKind kind) const
+{
+    return kind == CommitItem || kind == LocalFileItem;
+}
+
+bool TransactionQueue::isAptBusy() const
+{
+    return m_aptItemId != 0;
+}
+
+void TransactionQueue::append(const Item &item)
+{
+    beginInsertRows(QModelIndex(), m_items.size(), m_items.size());
+    m_items.append(item);
+    endInsertRows();
+    emit itemQueued();
+}
+
+void TransactionQueue::itemChanged(int row)
+{
+    emit dataChanged(index(row), index(row));
+}
+
+TransactionQueue::ChangeSet TransactionQueue::captureChanges() const
+{
+    ChangeSet changes;
+    if (!m_backend) {
+        return changes;
+    }
+
+    for (QApt::Package *package : m_backend->markedPackages()) {
+        const int state = package->state();
+
+        QApt::Package::State action;
+        if (state & QApt::Package::ToPurge) {
+            action = QApt::Package::ToPurge;
+        } else if (state & QApt::Package::ToRemove) {
+            action = QApt::Package::ToRemove;
+        } else if (state & QApt::Package::ToReInstall) {
+            action = QApt::Package::ToReInstall;
+        } else if (state & QApt::Package::ToDowngrade) {
+            action = QApt::Package::ToDowngrade;
+        } else if (state & QApt::Package::ToUpgrade) {
+            action = QApt::Package::ToUpgrade;
+        } else if (state & QApt::Package::NewInstall) {
+            if (state & QApt::Package::IsAuto) {
+                // Pulled in by a dependency; marking it again would make it manual
+                continue;
+            }
+            action = QApt::Package::ToInstall;
+        } else {
+            continue;
+        }
+
+        // Picked with setVersion() or the default candidate, either way the
+        // one to install when the item runs
+        const bool removal = action == QApt::Package::ToRemove || action == QApt::Package::ToPurge;
+        changes.append({ QString(package->name() % QLatin1Char(':') % package->architecture()), action,
+                         removal ? QString() : package->availableVersion() });
+    }
+
+    return changes;
+}
+
+void TransactionQueue::applyChanges(const ChangeSet &changes)
+{
+    if (!m_backend || changes.isEmpty()) {
+        return;
+    }
+
+    // Puts marks back that were there before, so it is not a step of its own
+    MarkingJournal *journal = QAptActions::self()->journal();
+    journal->suspend();
+
+    MarkingBatch batch(m_backend);
+    for (const MarkedChange &change : changes) {
+        QApt::Package *package = m_backend->package(change.name);
+        if (!package) {
+            qWarning() << "Queued change for" << change.name << "no longer applies";
+            continue;
+        }
+        // The candidate goes back to the default with every cache reload
+        if (!change.version.isEmpty() && package->availableVersion() != change.version
+                && !package->setVersion(change.version)) {
+            qWarning() << "Queued change for" << change.name << "needs version" << change.version
+                       << "which is no longer available";
+            continue;
+        }
+        batch.add(package, change.action);
+    }
+
+    batch.apply();
+    for (const MarkingBatch::Failure &failure : batch.failures()) {
+        qWarning() << "Queued change for" << failure.package->name() << "could not be marked again";
+    }
+    journal->resume();
+}
+
+void TransactionQueue::enqueueCommit()
+{
+    Item item;
+    item.id = m_nextId++;
+    item.kind = CommitItem;
+    item.state = QueuedState;
+    item.progress = 0;
+    item.changes = captureChanges();
+    if (item.changes.isEmpty()) {
+        return;
+    }
+    item.title = i18ncp("@item", "Apply %1 change", "Apply %1 changes", item.changes.size());
+
+    bool aptPending = isAptBusy();
+    for (const Item &queued : m_items) {
+        aptPending |= isAptKind(queued.kind) && queued.state == QueuedState;
+    }
+
+    append(item);
+    if (aptPending) {
+        // The changes live in the item now; free the list for the next ones
+        QAptActions::self()->revertChanges();
+    } else {
+        startAptItem(m_items.size() - 1, true);
+    }
+}
+
+void TransactionQueue::enqueueLocalFile(const QString &filePath)
+{
+    Item item;
+    item.id = m_nextId++;
+    item.kind = LocalFileItem;
+    item.state = QueuedState;
+    item.progress = 0;
+    item.target = filePath;
+    item.title = i18nc("@item", "Install %1", filePath.section(QLatin1Char('/'), -1));
+    append(item);
+
+    if (!isAptBusy()) {
+        runNextAptItem();
+    }
+}
+
+void TransactionQueue::enqueueFlatpakInstall(const QString &id, const QString &remote)
+{
+    Item item;
+    item.id = m_nextId++;
+    item.kind = FlatpakInstallItem;
+    item.state = QueuedState;
+    item.progress = 0;
+    item.target = id;
+    item.remote = remote;
+    item.title = i18nc("@item", "Install %1 (Flatpak)", id);
+    append(item);
+
+    runNextFlatpakItem();
+}
+
+void TransactionQueue::enqueueFlatpakRemove(const QString &id)
+{
+    Item item;
+    item.id = m_nextId++;
+    item.kind = FlatpakRemoveItem;
+    item.state = QueuedState;
+    item.progress = 0;
+    item.target = id;
+    item.title = i18nc("@item", "Remove %1 (Flatpak)", id);
+    append(item);
+
+    runNextFlatpakItem();
+}
+
+void TransactionQueue::cancel(int row)
+{
+    if (row < 0 || row >= m_items.size()) {
+        return;
+    }
+
+    Item &item = m_items[row];
+    if (item.state == QueuedState) {
+        item.state = CancelledState;
+        itemChanged(row);
+    } else if (item.id == m_aptItemId && m_aptItemSeeding) {
+        // Never run, so it is dropped here; the lane moves on once the
+        // seeder, which uses the worker itself, is done
+        if (item.trans) {
+            item.trans->deleteLater();
+            item.trans = nullptr;
+        }
+        item.state = CancelledState;
+        itemChanged(row);
+    } else if (item.trans) {
+        item.trans->cancel();
+    } else if (item.id == m_flatpakItemId) {
+        m_flatpakCancelRequested = true;
+        FlatpakManager::instance()->cancel(m_flatpakOperationId);
+    }
+}
+
+void TransactionQueue::clearFinished()
+{
+    for (int row = m_items.size() - 1; row >= 0; --row) {
+        const ItemState state = m_items.at(row).state;
+        if (state == FinishedState || state == FailedState || state == CancelledState) {
+            beginRemoveRows(QModelIndex(), row, row);
+            m_items.remove(row);
+            endRemoveRows();
+        }
+    }
+}
+
+void TransactionQueue::runNextAptItem()
+{
+    if (isAptBusy() || !m_backend) {
+        return;
+    }
+
+    for (int row = 0; row < m_items.size(); ++row) {
+        const Item &item = m_items.at(row);
+        if (isAptKind(item.kind) && item.state == QueuedState) {
+            startAptItem(row, false);
+            return;
+        }
+    }
+}
+
+void TransactionQueue::startAptItem(int row, bool marksApplied)
+{
+    Item &item = m_items[row];
+
+    QApt::Transaction *trans = nullptr;
+    bool seed = false;
+    qint64 expectedDuration = -1;
+    if (item.kind == CommitItem) {
+        // Whatever the user marked meanwhile is kept aside and put back,
+        // which is no change to undo
+        MarkingJournal *journal = QAptActions::self()->journal();
+        const ChangeSet pending = marksApplied ? ChangeSet() : captureChanges();
+        if (!marksApplied) {
+            journal->suspend();
+            QAptActions::self()->revertChanges();
+            applyChanges(item.changes);
+        }
+        trans = m_backend->commitChanges();
+        if (trans) {
+            // Both need the item's marks, which are reverted below
+            m_seeder->seed(m_backend);
+            seed = true;
+            expectedDuration = TransactionTimingModel::instance()->estimate(m_backend->markedPackages());
+        }
+        QAptActions::self()->revertChanges();
+        applyChanges(pending);
+        if (!marksApplied) {
+            journal->resume();
+        }
+    } else {
+        QApt::DebFile debFile(item.target);
+        if (debFile.isValid()) {
+            trans = m_backend->installFile(debFile);
+        }
+    }
+
+    if (!trans) {
+        item.state = FailedState;
+        itemChanged(row);
+        runNextAptItem();
+        return;
+    }
+
+    const quint64 id = item.id;
+    item.trans = trans;
+    item.state = RunningState;
+    m_aptItemId = id;
+    itemChanged(row);
+    emit aptBusyChanged(true);
+
+    connect(trans, &QApt::Transaction::progressChanged, this, [this, id](int progress) {
+        const int row = rowOf(id);
+        if (row != -1) {
+            m_items[row].progress = progress;
+            itemChanged(row);
+        }
+    });
+    connect(trans, &QApt::Transaction::statusChanged, this, [this, id, trans](QApt::TransactionStatus status) {
+        const int row = rowOf(id);
+        if (row == -1) {
+            return;
+        }
+
+        Item &item = m_items[row];
+        switch (status) {
+        case QApt::DownloadingStatus:
+            item.state = DownloadingState;
+            item.progress = 0;
+            break;
+        case QApt::CommittingStatus:
+            item.state = RunningState;
+            item.progress = 0;
+            break;
+        case QApt::FinishedStatus:
+            switch (trans->exitStatus()) {
+            case QApt::ExitSuccess:
+                finishAptItem(id, FinishedState);
+                break;
+            case QApt::ExitCancelled:
+                finishAptItem(id, CancelledState);
+                break;
+            default:
+                finishAptItem(id, FailedState);
+                break;
+            }
+            return;
+        default:
+            break;
+        }
+        itemChanged(row);
+    });
+
+    if (!seed) {
+        emit aptTransactionStarted(trans, expectedDuration);
+        return;
+    }
+
+    // The commit runs once local copies of its archives are in the cache
+    m_aptItemSeeding = true;
+    QPointer<QApt::Transaction> pendingTrans = trans;
+    connect(m_seeder, &LocalArchiveSeeder::finished, this, [this, id, pendingTrans, expectedDuration]() {
+        disconnect(m_seeder, &LocalArchiveSeeder::finished, this, nullptr);
+        m_aptItemSeeding = false;
+        if (pendingTrans) {
+            emit aptTransactionStarted(pendingTrans, expectedDuration);
+            return;
+        }
+
+        // Cancelled or gone before it could run, so nothing reloads the cache
+        const int row = rowOf(id);
+        const bool cancelled = row != -1 && m_items.at(row).state == CancelledState;
+        finishAptItem(id, cancelled ? CancelledState : FailedState);
+        runNextAptItem();
+    });
+}
+
+void TransactionQueue::finishAptItem(quint64 id, ItemState state)
+{
+    const int row = rowOf(id);
+    if (row != -1) {
+        Item &item = m_items[row];
+        item.state = state;
+        item.trans = nullptr;
+        itemChanged(row);
+    }
+
+    m_aptItemId = 0;
+    emit aptBusyChanged(false);
+}
+
+void TransactionQueue::runNextFlatpakItem()
+{
+    if (m_flatpakItemId != 0) {
+        return;
+    }
+
+    for (int row = 0; row < m_items.size(); ++row) {
+        Item &item = m_items[row];
+        if (isAptKind(item.kind) || item.state != QueuedState) {
+            continue;
+        }
+
+        item.state = RunningState;
+        m_flatpakItemId = item.id;
+        itemChanged(row);
+
+        if (item.kind == FlatpakInstallItem) {
+            m_flatpakOperationId = FlatpakManager::instance()->installPackage(item.target, item.remote);
+        } else {
+            m_flatpakOperationId = FlatpakManager::instance()->removePackage(item.target);
+        }
+        return;
+    }
+}
+
+void TransactionQueue::flatpakOperationProgress(quint64 operationId, int percent)
+{
+    const int row = rowOf(m_flatpakItemId);
+    if (row == -1 || operationId != m_flatpakOperationId || percent < 0) {
+        return;
+    }
+
+    m_items[row].progress = percent;
+    itemChanged(row);
+}
+
+void TransactionQueue::flatpakOperationFinished(quint64 operationId, bool success)
+{
+    // Operations started outside the queue report here too
+    const int row = rowOf(m_flatpakItemId);
+    if (row == -1 || operationId != m_flatpakOperationId) {
+        return;
+    }
+
+    Item &item = m_items[row];
+    if (success) {
+        item.state = FinishedState;
+    } else {
+        item.state = m_flatpakCancelRequested ? CancelledState : FailedState;
+    }
+    m_flatpakItemId = 0;
+    m_flatpakOperationId = 0;
+    m_flatpakCancelRequested = false;
+    itemChanged(row);
+
+    runNextFlatpakItem();
+}
@@ -0,0 +1,172 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef TRANSACTIONQUEUE_H
+#define TRANSACTIONQUEUE_H
+
+#include <QAbstractListModel>
+#include <QPointer>
+#include <QVector>
+
+#include <QApt/Globals>
+#include <QApt/Package>
+
+namespace QApt {
+    class Backend;
+    class Transaction;
+}
+
+class LocalArchiveSeeder;
+
+/**
+ * Queue of package operations: APT commits, local .deb installs and
+ * Flatpak installs and removals.
+ *
+ * APT items run one after the other, as the QApt worker only runs one
+ * transaction at a time. A commit captures the marked changes by package
+ * and version when it is queued, so the package list is free for the next set of
+ * changes right away, and the marks are reapplied when its turn comes.
+ * Flatpak items run in a lane of their own, alongside the APT items.
+ *
+ * The queue is also the model of the queue panel, one row per item.
+ */
+class TransactionQueue : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    enum ItemKind {
+        CommitItem,
+        LocalFileItem,
+        FlatpakInstallItem,
+        FlatpakRemoveItem
+    };
+
+    enum ItemState {
+        QueuedState,
+        DownloadingState,
+        RunningState,
+        FinishedState,
+        FailedState,
+        CancelledState
+    };
+
+    enum Roles {
+        KindRole = Qt::UserRole,
+        StateRole = Qt::UserRole + 1,
+        ProgressRole = Qt::UserRole + 2
+    };
+
+    struct MarkedChange {
+        // name:arch, so foreign-architecture marks find their package again
+        QString name;
+        QApt::Package::State action;
+        // The version to install, empty for removals
+        QString version;
+    };
+    typedef QVector<MarkedChange> ChangeSet;
+
+    static TransactionQueue *instance();
+
+    void setBackend(QApt::Backend *backend);
+
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+
+    /// Queues the currently marked changes
+    void enqueueCommit();
+    void enqueueLocalFile(const QString &filePath);
+    void enqueueFlatpakInstall(const QString &id, const QString &remote);
+    void enqueueFlatpakRemove(const QString &id);
+
+    /// Drops a queued item, or cancels it if it is running
+    void cancel(int row);
+    void clearFinished();
+
+    bool isAptBusy() const;
+
+    /**
+     * @returns the marked changes by package and version. Packages only
+     * pulled in as dependencies are left out, they follow from the rest.
+     */
+    ChangeSet captureChanges() const;
+    void applyChanges(const ChangeSet &changes);
+
+    /**
+     * Starts the next queued APT item, if any. Called once the cache has
+     * been reloaded after the previous one, so it marks against fresh data.
+     */
+    void runNextAptItem();
+
+Q_SIGNALS:
+    /**
+     * A transaction for the next APT item is ready to be set up and run.
+     * @p expectedDuration is the estimate for its changes in seconds, or -1
+     */
+    void aptTransactionStarted(QApt::Transaction *trans, qint64 expectedDuration);
+    void itemQueued();
+    /// An APT item started running, or the running one finished
+    void aptBusyChanged(bool busy);
+
+private:
+    explicit TransactionQueue(QObject *parent = nullptr);
+
+    struct Item {
+        quint64 id;
+        ItemKind kind;
+        ItemState state;
+        int progress;
+        QString title;
+        ChangeSet changes;
+        QString target;
+        QString remote;
+        QPointer<QApt::Transaction> trans;
+    };
+
+    static TransactionQueue *s_instance;
+
+    QApt::Backend *m_backend;
+    QVector<Item> m_items;
+    quint64 m_nextId;
+    // Items currently running in each lane, 0 when the lane is idle
+    quint64 m_aptItemId;
+    quint64 m_flatpakItemId;
+    // The running APT item's transaction waits for LocalArchiveSeeder
+    bool m_aptItemSeeding;
+    // FlatpakManager's id for the running Flatpak item's operation
+    quint64 m_flatpakOperationId;
+    bool m_flatpakCancelRequested;
+    LocalArchiveSeeder *m_seeder;
+
+    int rowOf(quint64 id) const;
+    bool isAptKind(ItemKind kind) const;
+    void append(const Item &item);
+    void itemChanged(int row);
+    void startAptItem(int row, bool marksApplied);
+    /// Leaves the APT lane idle, with the item @p id, if still listed, in @p state
+    void finishAptItem(quint64 id, ItemState state);
+    void runNextFlatpakItem();
+    QString stateText(const Item &item) const;
+
+private Q_SLOTS:
+    void flatpakOperationProgress(quint64 operationId, int percent);
+    void flatpakOperationFinished(quint64 operationId, bool success);
+};
+
+#endif // TRANSACTIONQUEUE_H
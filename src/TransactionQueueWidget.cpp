@@ -0,0 +1,98 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "TransactionQueueWidget.h"
+
+// Qt includes
+#include <QHBoxLayout>
+#include <QListView>
+#include <QPushButton>
+#include <QVBoxLayout>
+
+// KDE includes
+#include <KLocalizedString>
+
+// Own includes
+#include "TransactionQueue.h"
+
+TransactionQueueWidget::TransactionQueueWidget(TransactionQueue *queue, QWidget *parent)
+    : QWidget(parent)
+    , m_queue(queue)
+{
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setMargin(0);
+
+    m_view = new QListView(this);
+    m_view->setModel(m_queue);
+    m_view->setUniformItemSizes(true);
+    m_view->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_view->setSelectionMode(QAbstractItemView::SingleSelection);
+    layout->addWidget(m_view);
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout;
+    layout->addLayout(buttonLayout);
+
+    QPushButton *progressButton = new QPushButton(QIcon::fromTheme("view-process-system"),
+                                                  i18nc("@action:button", "Show Progress"), this);
+    QPushButton *packagesButton = new QPushButton(QIcon::fromTheme("view-list-details"),
+                                                  i18nc("@action:button", "Show Packages"), this);
+    m_cancelButton = new QPushButton(QIcon::fromTheme("dialog-cancel"),
+                                     i18nc("@action:button", "Cancel"), this);
+    QPushButton *clearButton = new QPushButton(QIcon::fromTheme("edit-clear-history"),
+                                               i18nc("@action:button", "Clear Finished"), this);
+    buttonLayout->addWidget(progressButton);
+    buttonLayout->addWidget(packagesButton);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(m_cancelButton);
+    buttonLayout->addWidget(clearButton);
+
+    connect(progressButton, &QPushButton::clicked, this, &TransactionQueueWidget::showProgressRequested);
+    connect(packagesButton, &QPushButton::clicked, this, &TransactionQueueWidget::showPackagesRequested);
+    connect(m_cancelButton, &QPushButton::clicked, this, &TransactionQueueWidget::cancelSelected);
+    connect(clearButton, &QPushButton::clicked, m_queue, &TransactionQueue::clearFinished);
+
+    connect(m_view->selectionModel(), &QItemSelectionModel::currentChanged,
+            this, &TransactionQueueWidget::updateButtons);
+    connect(m_queue, &TransactionQueue::dataChanged, this, &TransactionQueueWidget::updateButtons);
+    connect(m_queue, &TransactionQueue::rowsRemoved, this, &TransactionQueueWidget::updateButtons);
+    updateButtons();
+}
+
+void TransactionQueueWidget::updateButtons()
+{
+    const QModelIndex current = m_view->currentIndex();
+    if (!current.isValid()) {
+        m_cancelButton->setEnabled(false);
+        return;
+    }
+
+    const int state = current.data(TransactionQueue::StateRole).toInt();
+    m_cancelButton->setEnabled(state == TransactionQueue::QueuedState
+                            || state == TransactionQueue::DownloadingState
+                            || state == TransactionQueue::RunningState);
+}
+
+void TransactionQueueWidget::cancelSelected()
+{
+    const QModelIndex current = m_view->currentIndex();
+    if (current.isValid()) {
+        m_queue->cancel(current.row());
+    }
+}
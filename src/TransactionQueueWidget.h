@@ -0,0 +1,54 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef TRANSACTIONQUEUEWIDGET_H
+#define TRANSACTIONQUEUEWIDGET_H
+
+#include <QWidget>
+
+class QListView;
+class QPushButton;
+
+class TransactionQueue;
+
+/**
+ * Panel listing the items of the transaction queue and their state.
+ */
+class TransactionQueueWidget : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit TransactionQueueWidget(TransactionQueue *queue, QWidget *parent = nullptr);
+
+Q_SIGNALS:
+    void showProgressRequested();
+    void showPackagesRequested();
+
+private:
+    TransactionQueue *m_queue;
+    QListView *m_view;
+    QPushButton *m_cancelButton;
+
+private Q_SLOTS:
+    void updateButtons();
+    void cancelSelected();
+};
+
+#endif // TRANSACTIONQUEUEWIDGET_H
@@ -23,6 +23,7 @@
 // Qt includes
 #include <QtCore/QDir>
 #include <QtCore/QStringBuilder>
+#include <QtCore/QTimer>
 #include <QtCore/QUuid>
 #include <QtWidgets/QHeaderView>
 #include <QtWidgets/QLabel>
@@ -33,6 +34,7 @@
 #include <QDebug>
 
 // KDE includes
+#include <KFormat>
 #include <KLocalizedString>
 #include <KMessageBox>
 
@@ -44,13 +46,18 @@
 
 // Own includes
 #include "muonapt/MuonStrings.h"
+#include "muonapt/TransactionTimingModel.h"
 #include "DownloadModel/DownloadDelegate.h"
 #include "DownloadModel/DownloadModel.h"
+#include "DownloadModel/DownloadTelemetry.h"
 
 TransactionWidget::TransactionWidget(QWidget *parent)
     : QWidget(parent)
     , m_trans(nullptr)
     , m_lastRealProgress(0)
+    , m_expectedDuration(-1)
+    , m_pendingProgress(-1)
+    , m_hasPendingStatusDetails(false)
 {
     QVBoxLayout *layout = new QVBoxLayout(this);
     layout->setMargin(0);
@@ -80,6 +87,13 @@ TransactionWidget::TransactionWidget(QWidget *parent)
     m_downloadView->header()->setSectionResizeMode(1, QHeaderView::Stretch);
     m_downloadView->hide();
 
+    // Per-mirror throughput, shown under the download list while fetching
+    m_telemetry = new DownloadTelemetry(this);
+    m_telemetryLabel = new QLabel(this);
+    m_telemetryLabel->setTextFormat(Qt::PlainText);
+    m_telemetryLabel->hide();
+    layout->addWidget(m_telemetryLabel);
+
     QString uuid = QUuid::createUuid().toString();
     uuid.remove('{').remove('}').remove('-');
     m_pipe = QDir::tempPath() % QLatin1String("/qapt-sock-") % uuid;
@@ -110,6 +124,11 @@ TransactionWidget::TransactionWidget(QWidget *parent)
     m_cancelButton->setIcon(QIcon::fromTheme("dialog-cancel"));
     hboxLayout->addWidget(m_cancelButton);
     connect(m_downloadModel, SIGNAL(rowsInserted(QModelIndex,int,int)), m_downloadView, SLOT(scrollToBottom()));
+
+    m_labelTimer = new QTimer(this);
+    m_labelTimer->setSingleShot(true);
+    m_labelTimer->setInterval(16);
+    connect(m_labelTimer, SIGNAL(timeout()), this, SLOT(flushLabels()));
 }
 
 QString TransactionWidget::pipe() const
@@ -120,6 +139,7 @@ QString TransactionWidget::pipe() const
 void TransactionWidget::setTransaction(QApt::Transaction *trans)
 {
     m_trans = trans;
+    m_expectedDuration = -1;
 
     // Connect the transaction all up to our slots
     connect(m_trans, SIGNAL(statusChanged(QApt::TransactionStatus)),
@@ -137,9 +157,12 @@ void TransactionWidget::setTransaction(QApt::Transaction *trans)
     connect(m_trans, SIGNAL(progressChanged(int)),
             this, SLOT(updateProgress(int)));
     connect(m_trans, SIGNAL(statusDetailsChanged(QString)),
-            m_statusLabel, SLOT(setText(QString)));
+            this, SLOT(updateStatusDetails(QString)));
     connect(m_trans, SIGNAL(downloadProgressChanged(QApt::DownloadProgress)),
             m_downloadModel, SLOT(updateDetails(QApt::DownloadProgress)));
+    connect(m_trans, SIGNAL(downloadProgressChanged(QApt::DownloadProgress)),
+            this, SLOT(updateTelemetry(QApt::DownloadProgress)));
+    m_telemetry->start(m_trans->transactionId());
 
     // Connect us to the transaction
     connect(m_cancelButton, SIGNAL(clicked()), m_trans, SLOT(cancel()));
@@ -148,6 +171,9 @@ void TransactionWidget::setTransaction(QApt::Transaction *trans)
 
 void TransactionWidget::statusChanged(QApt::TransactionStatus status)
 {
+    // Anything still pending happened before this change
+    flushLabels();
+
     switch (status) {
     case QApt::SetupStatus:
         m_headerLabel->setText(xi18nc("@info Status information, widget title",
@@ -201,6 +227,7 @@ void TransactionWidget::statusChanged(QApt::TransactionStatus status)
     case QApt::DownloadingStatus:
         m_totalProgress->setMaximum(100);
         m_downloadView->show();
+        m_telemetryLabel->show();
         switch (m_trans->role()) {
         case QApt::UpdateCacheRole:
             m_headerLabel->setText(xi18nc("@info Status information, widget title",
@@ -218,18 +245,34 @@ void TransactionWidget::statusChanged(QApt::TransactionStatus status)
     case QApt::CommittingStatus:
         m_totalProgress->setMaximum(100);
         m_downloadView->hide();
+        m_telemetryLabel->hide();
         m_spacer->show();
 
         m_headerLabel->setText(xi18nc("@info Status information, widget title",
                                      "<title>Committing Changes</title>"));
+        m_commitTimer.start();
+        updateTimeLeft();
         break;
-    case QApt::FinishedStatus:
+    case QApt::FinishedStatus: {
+        const QString outcome = m_trans->exitStatus() == QApt::ExitSuccess
+                ? QStringLiteral("success") : QStringLiteral("failure");
+        m_telemetry->writeLog(outcome);
+
         m_spacer->hide();
         m_downloadView->hide();
+        m_telemetryLabel->hide();
         m_downloadModel->clear();
         m_headerLabel->setText(xi18nc("@info Status information, widget title",
                                      "<title>Finished</title>"));
         m_lastRealProgress = 0;
+        m_expectedDuration = -1;
+        m_commitTimer.invalidate();
+        m_totalProgress->resetFormat();
+
+        // Learn how long this one took
+        TransactionTimingModel::instance()->update();
+        break;
+    }
     }
 }
 
@@ -307,11 +350,107 @@ void TransactionWidget::configFileConflict(const QString &currentPath, const QSt
 
 void TransactionWidget::updateProgress(int progress)
 {
+    m_pendingProgress = progress;
+    if (!m_labelTimer->isActive()) {
+        m_labelTimer->start();
+    }
+}
+
+void TransactionWidget::updateStatusDetails(const QString &details)
+{
+    m_pendingStatusDetails = details;
+    m_hasPendingStatusDetails = true;
+    if (!m_labelTimer->isActive()) {
+        m_labelTimer->start();
+    }
+}
+
+void TransactionWidget::updateTelemetry(const QApt::DownloadProgress &details)
+{
+    m_telemetry->updateDetails(details);
+    if (!m_labelTimer->isActive()) {
+        m_labelTimer->start();
+    }
+}
+
+void TransactionWidget::flushLabels()
+{
+    m_labelTimer->stop();
+
+    if (m_telemetryLabel->isVisible()) {
+        KFormat format;
+        QStringList lines;
+
+        const qint64 eta = m_telemetry->eta();
+        if (eta > 0) {
+            lines << i18nc("@info:status download speed, time left", "%1/s, %2 remaining",
+                           format.formatByteSize(m_telemetry->bytesPerSecond()),
+                           format.formatSpelloutDuration(quint64(eta) * 1000));
+        } else {
+            lines << i18nc("@info:status download speed", "%1/s",
+                           format.formatByteSize(m_telemetry->bytesPerSecond()));
+        }
+
+        for (const DownloadTelemetry::HostStats &host : m_telemetry->hostStats()) {
+            QString line = i18nc("@info:status host: speed, items done of total",
+                                 "%1: %2/s, %3 of %4 files",
+                                 host.host, format.formatByteSize(host.bytesPerSecond),
+                                 host.finishedItems, host.items);
+            if (host.meanFirstByteMs >= 0) {
+                line += i18nc("@info:status latency to first byte", ", first byte after %1 ms",
+                              host.meanFirstByteMs);
+            }
+            if (host.retries > 0) {
+                line += i18ncp("@info:status", ", %1 retry", ", %1 retries", host.retries);
+            }
+            lines << line;
+        }
+        m_telemetryLabel->setText(lines.join(QLatin1Char('\n')));
+    }
+
+    if (m_hasPendingStatusDetails) {
+        m_statusLabel->setText(m_pendingStatusDetails);
+        m_hasPendingStatusDetails = false;
+    }
+
+    const int progress = m_pendingProgress;
+    m_pendingProgress = -1;
+    if (progress == -1) {
+        return;
+    }
+
     if (progress > 100) {
         m_totalProgress->setMaximum(0);
     } else if (progress > m_lastRealProgress) {
         m_totalProgress->setMaximum(100);
         m_totalProgress->setValue(progress);
         m_lastRealProgress = progress;
+        updateTimeLeft();
+    }
+}
+
+void TransactionWidget::setExpectedDuration(qint64 seconds)
+{
+    m_expectedDuration = seconds;
+    updateTimeLeft();
+}
+
+void TransactionWidget::updateTimeLeft()
+{
+    if (m_expectedDuration <= 0 || !m_commitTimer.isValid()) {
+        return;
     }
+
+    const int progress = m_lastRealProgress;
+    const double elapsed = m_commitTimer.elapsed() / 1000.0;
+    double remaining = qMax(0.0, m_expectedDuration - elapsed);
+    if (progress > 0 && progress < 100) {
+        // The pace of this commit counts for more the further along it is
+        const double observed = elapsed * (100 - progress) / progress;
+        remaining = (remaining * (100 - progress) + observed * progress) / 100;
+    }
+
+    m_totalProgress->setFormat(i18nc("@info:progress %p% is the percentage done, %1 the time left",
+                                     "%p%, about %1 remaining",
+                                     KFormat().formatSpelloutDuration(quint64(remaining) * 1000)));
 }
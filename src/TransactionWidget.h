@@ -21,13 +21,16 @@
 #ifndef TRANSACTIONWIDGET_H
 #define TRANSACTIONWIDGET_H
 
+#include <QtCore/QElapsedTimer>
 #include <QtWidgets/QWidget>
 
+#include <QApt/DownloadProgress>
 #include <QApt/Globals>
 
 class QLabel;
 class QProgressBar;
 class QPushButton;
+class QTimer;
 class QTreeView;
 
 namespace QApt {
@@ -43,6 +46,7 @@ namespace DebconfKde
 
 class DownloadModel;
 class DownloadDelegate;
+class DownloadTelemetry;
 
 class TransactionWidget : public QWidget
 {
@@ -52,10 +56,14 @@ public:
 
     QString pipe() const;
     void setTransaction(QApt::Transaction *trans);
+    /// How long committing is expected to take, in seconds, -1 if unknown
+    void setExpectedDuration(qint64 seconds);
     
 private:
     QApt::Transaction *m_trans;
     int m_lastRealProgress;
+    qint64 m_expectedDuration;
+    QElapsedTimer m_commitTimer;
     QString m_pipe;
 
     QLabel *m_headerLabel;
@@ -63,6 +71,8 @@ private:
     QTreeView *m_downloadView;
     DownloadModel *m_downloadModel;
     DownloadDelegate *m_downloadDelegate;
+    DownloadTelemetry *m_telemetry;
+    QLabel *m_telemetryLabel;
 #ifdef HAVE_DEBCONFKDE
     DebconfKde::DebconfGui *m_debconfGui;
 #endif
@@ -70,6 +80,12 @@ private:
     QLabel *m_statusLabel;
     QPushButton *m_cancelButton;
 
+    // Progress and status details are applied at most once per frame
+    QTimer *m_labelTimer;
+    int m_pendingProgress;
+    QString m_pendingStatusDetails;
+    bool m_hasPendingStatusDetails;
+
 private slots:
     void statusChanged(QApt::TransactionStatus status);
     void transactionErrorOccurred(QApt::ErrorCode error);
@@ -77,6 +93,10 @@ private slots:
     void untrustedPrompt(const QStringList &untrustedPackages);
     void configFileConflict(const QString &currentPath, const QString &newPath);
     void updateProgress(int progress);
+    void updateStatusDetails(const QString &details);
+    void updateTelemetry(const QApt::DownloadProgress &details);
+    void flushLabels();
+    void updateTimeLeft();
 };
 
 #endif // TRANSACTIONWIDGET_H
@@ -23,6 +23,7 @@
 #include <QCheckBox>
 #include <QHBoxLayout>
 #include <QLabel>
+#include <QLineEdit>
 #include <QSpinBox>
 #include <QFormLayout>
 #include <QPushButton>
@@ -49,9 +50,11 @@ GeneralSettingsPage::GeneralSettingsPage(QWidget* parent, QApt::Config *aptConfi
         , m_autoCleanSpinbox(new QSpinBox(this))
         , m_useSlowSearchCheckBox(new QCheckBox(this))
         , m_confirmOnQuitCheckBox(new QCheckBox(this))
+        , m_prefetchArchivesCheckBox(new QCheckBox(this))
         , m_startOnDashboardCheckBox(new QCheckBox(this))
         , m_showVersionColumnsCheckBox(new QCheckBox(this))
         , m_statusColorsButton(new QPushButton(this))
+        , m_changelogUrlEdit(new QLineEdit(this))
 {
     QFormLayout *layout = new QFormLayout(this);
     layout->setMargin(0);
@@ -64,9 +67,14 @@ GeneralSettingsPage::GeneralSettingsPage(QWidget* parent, QApt::Config *aptConfi
     m_untrustedCheckBox->setText(i18n("Allow the installation of untrusted packages"));
     m_useSlowSearchCheckBox->setText(i18n("Use supplemental slow search when xapian search is not available"));
     m_confirmOnQuitCheckBox->setText(i18n("Show confirmation dialog when quitting with pending changes"));
+    m_prefetchArchivesCheckBox->setText(i18n("Start downloading marked packages before changes are applied"));
     m_startOnDashboardCheckBox->setText(i18n("Show Dashboard on startup"));
     m_showVersionColumnsCheckBox->setText(i18n("Show installed and available version columns by default"));
     m_statusColorsButton->setText(i18n("Configure Status Column Colors..."));
+    m_changelogUrlEdit->setPlaceholderText(i18n("Provided by the package origin"));
+    m_changelogUrlEdit->setClearButtonEnabled(true);
+    m_changelogUrlEdit->setToolTip(i18n("Fetch changelogs from a mirror instead, for example "
+                                        "file:///srv/changelogs/{prefix}/{source}/{source}_{version}/changelog"));
 
     m_multiArchDupesBox->setEnabled(aptConfig->architectures().size() > 1);
 
@@ -102,6 +110,8 @@ GeneralSettingsPage::GeneralSettingsPage(QWidget* parent, QApt::Config *aptConfi
     behaviorLayout->addRow(autoCleanWidget);
     behaviorLayout->addRow(m_useSlowSearchCheckBox);
     behaviorLayout->addRow(m_confirmOnQuitCheckBox);
+    behaviorLayout->addRow(m_prefetchArchivesCheckBox);
+    behaviorLayout->addRow(i18n("Changelog URL:"), m_changelogUrlEdit);
     
     QGroupBox *appearanceGroup = new QGroupBox(i18n("Appearance"), this);
     QFormLayout *appearanceLayout = new QFormLayout(appearanceGroup);
@@ -123,9 +133,11 @@ GeneralSettingsPage::GeneralSettingsPage(QWidget* parent, QApt::Config *aptConfi
     connect(m_autoCleanSpinbox, SIGNAL(valueChanged(int)), this, SLOT(emitAuthChanged()));
     connect(m_useSlowSearchCheckBox, SIGNAL(clicked()), this, SIGNAL(changed()));
     connect(m_confirmOnQuitCheckBox, SIGNAL(clicked()), this, SIGNAL(changed()));
+    connect(m_prefetchArchivesCheckBox, SIGNAL(clicked()), this, SIGNAL(changed()));
     connect(m_startOnDashboardCheckBox, SIGNAL(clicked()), this, SIGNAL(changed()));
     connect(m_showVersionColumnsCheckBox, SIGNAL(clicked()), this, SLOT(applyVersionColumnsSetting()));
     connect(m_statusColorsButton, SIGNAL(clicked()), this, SLOT(editStatusColors()));
+    connect(m_changelogUrlEdit, SIGNAL(textEdited(QString)), this, SIGNAL(changed()));
 
     connect(m_autoCleanSpinbox, SIGNAL(valueChanged(int)),
             this, SLOT(updateAutoCleanSpinboxSuffix()));
@@ -150,8 +162,10 @@ void GeneralSettingsPage::loadSettings()
     m_undoStackSpinbox->setValue(settings->undoStackSize());
     m_useSlowSearchCheckBox->setChecked(settings->useSlowSearch());
     m_confirmOnQuitCheckBox->setChecked(settings->confirmOnQuit());
+    m_prefetchArchivesCheckBox->setChecked(settings->prefetchArchives());
     m_startOnDashboardCheckBox->setChecked(settings->startOnDashboard());
     m_showVersionColumnsCheckBox->setChecked(settings->showVersionColumns());
+    m_changelogUrlEdit->setText(settings->changelogUrlTemplate());
 
     int autoCleanValue = m_aptConfig->readEntry("APT::Periodic::AutocleanInterval", 0);
     m_autoCleanCheckBox->setChecked(autoCleanValue > 0);
@@ -167,8 +181,10 @@ void GeneralSettingsPage::applySettings()
     settings->setUndoStackSize(m_undoStackSpinbox->value());
     settings->setUseSlowSearch(m_useSlowSearchCheckBox->isChecked());
     settings->setConfirmOnQuit(m_confirmOnQuitCheckBox->isChecked());
+    settings->setPrefetchArchives(m_prefetchArchivesCheckBox->isChecked());
     settings->setStartOnDashboard(m_startOnDashboardCheckBox->isChecked());
     settings->setShowVersionColumns(m_showVersionColumnsCheckBox->isChecked());
+    settings->setChangelogUrlTemplate(m_changelogUrlEdit->text().trimmed());
     settings->save();
 
     // Only write if changed. Unnecessary password dialogs ftl
@@ -26,6 +26,7 @@
 #include "../settings/SettingsPageBase.h"
 
 class QCheckBox;
+class QLineEdit;
 class QPushButton;
 class QSpinBox;
 
@@ -66,9 +67,11 @@ private:
     QSpinBox *m_autoCleanSpinbox;
     QCheckBox *m_useSlowSearchCheckBox;
     QCheckBox *m_confirmOnQuitCheckBox;
+    QCheckBox *m_prefetchArchivesCheckBox;
     QCheckBox *m_startOnDashboardCheckBox;
     QCheckBox *m_showVersionColumnsCheckBox;
     QPushButton *m_statusColorsButton;
+    QLineEdit *m_changelogUrlEdit;
 
     int autoCleanValue() const;
 };
@@ -0,0 +1,202 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "ArchivePrefetcher.h"
+
+#include <clocale>
+
+// Qt includes
+#include <QDebug>
+#include <QFile>
+#include <QStringBuilder>
+#include <QTimer>
+
+// KDE includes
+#include <KProtocolManager>
+
+// QApt includes
+#include <QApt/Backend>
+#include <QApt/Config>
+#include <QApt/Package>
+#include <QApt/Transaction>
+
+// Own includes
+#include "MuonSettings.h"
+#include "../TransactionQueue.h"
+
+ArchivePrefetcher *ArchivePrefetcher::s_instance = nullptr;
+
+ArchivePrefetcher *ArchivePrefetcher::instance()
+{
+    if (!s_instance) {
+        s_instance = new ArchivePrefetcher();
+    }
+    return s_instance;
+}
+
+ArchivePrefetcher::ArchivePrefetcher(QObject *parent)
+    : QObject(parent)
+    , m_backend(nullptr)
+    , m_restartPending(false)
+{
+    // Marking often comes in bursts (dependencies, upgrade all); wait for
+    // it to settle instead of restarting the download for every package
+    m_settleTimer = new QTimer(this);
+    m_settleTimer->setSingleShot(true);
+    m_settleTimer->setInterval(2000);
+    connect(m_settleTimer, &QTimer::timeout, this, &ArchivePrefetcher::update);
+
+    // A running commit takes the download lock and marks its own changes;
+    // pick up what the user marked meanwhile once it is done
+    connect(TransactionQueue::instance(), &TransactionQueue::aptBusyChanged, this, [this](bool busy) {
+        if (busy) {
+            stop();
+        } else {
+            m_settleTimer->start();
+        }
+    });
+}
+
+void ArchivePrefetcher::setBackend(QApt::Backend *backend)
+{
+    if (m_backend) {
+        disconnect(m_backend, nullptr, this, nullptr);
+    }
+    m_backend = backend;
+
+    connect(m_backend, &QApt::Backend::packageChanged,
+            m_settleTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
+    connect(m_backend, &QApt::Backend::cacheReloadStarted,
+            this, &ArchivePrefetcher::stop);
+}
+
+void ArchivePrefetcher::stop()
+{
+    m_settleTimer->stop();
+    m_restartPending = false;
+    if (m_trans) {
+        m_trans->cancel();
+    }
+}
+
+QString ArchivePrefetcher::archiveDirectory() const
+{
+    return m_backend->config()->findDirectory(QStringLiteral("Dir::Cache::Archives"),
+                                              QStringLiteral("/var/cache/apt/archives/"));
+}
+
+bool ArchivePrefetcher::isArchiveCached(QApt::Package *package) const
+{
+    // APT names archives <name>_<version>_<arch>.deb, with the epoch colon escaped
+    QString version = package->availableVersion();
+    version.replace(QLatin1Char(':'), QLatin1String("%3a"));
+    const QString base = archiveDirectory() % package->name() % QLatin1Char('_') % version % QLatin1Char('_');
+
+    return QFile::exists(base % package->architecture() % QLatin1String(".deb"))
+            || QFile::exists(base % QLatin1String("all.deb"));
+}
+
+QSet<QString> ArchivePrefetcher::missingArchives() const
+{
+    QSet<QString> archives;
+    const int fetchStates = QApt::Package::ToInstall | QApt::Package::ToUpgrade
+                          | QApt::Package::ToReInstall | QApt::Package::ToDowngrade;
+
+    for (QApt::Package *package : m_backend->markedPackages()) {
+        if (!(package->state() & fetchStates) || isArchiveCached(package)) {
+            continue;
+        }
+        archives.insert(package->name() % QLatin1Char('_') % package->availableVersion());
+    }
+
+    return archives;
+}
+
+void ArchivePrefetcher::update()
+{
+    if (!m_backend || !MuonSettings::self()->prefetchArchives()
+            || TransactionQueue::instance()->isAptBusy()) {
+        stop();
+        return;
+    }
+
+    const QSet<QString> archives = missingArchives();
+    if (m_trans) {
+        // Packages were marked or unmarked since the download started
+        if (archives != m_fetching) {
+            m_restartPending = true;
+            m_trans->cancel();
+        }
+        return;
+    }
+
+    if (!archives.isEmpty()) {
+        start(archives);
+    }
+}
+
+void ArchivePrefetcher::start(const QSet<QString> &archives)
+{
+    if (!m_listDir.isValid()) {
+        qWarning() << "Cannot prefetch archives: no temporary directory for the download list";
+        return;
+    }
+
+    // The list covers every marked package; archives already in the cache
+    // are verified and skipped by the download itself
+    const QString listFile = m_listDir.path() % QLatin1String("/prefetch-list");
+    if (!m_backend->saveDownloadList(listFile)) {
+        qWarning() << "Cannot prefetch archives: writing the download list failed";
+        return;
+    }
+
+    m_trans = m_backend->downloadArchives(listFile, archiveDirectory());
+    if (!m_trans) {
+        return;
+    }
+
+    if (KProtocolManager::proxyType() == KProtocolManager::ManualProxy) {
+        m_trans->setProxy(KProtocolManager::proxyFor("http"));
+    }
+    m_trans->setLocale(QLatin1String(setlocale(LC_MESSAGES, 0)));
+
+    // Errors need no handling: whatever is still missing is fetched on commit
+    connect(m_trans.data(), &QApt::Transaction::statusChanged,
+            this, &ArchivePrefetcher::transactionStatusChanged);
+
+    m_fetching = archives;
+    m_trans->run();
+}
+
+void ArchivePrefetcher::transactionStatusChanged(QApt::TransactionStatus status)
+{
+    if (status != QApt::FinishedStatus) {
+        return;
+    }
+
+    m_trans->deleteLater();
+    m_trans = nullptr;
+    m_fetching.clear();
+
+    if (m_restartPending) {
+        m_restartPending = false;
+        update();
+    }
+}
@@ -0,0 +1,88 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef ARCHIVEPREFETCHER_H
+#define ARCHIVEPREFETCHER_H
+
+#include <QObject>
+#include <QPointer>
+#include <QSet>
+#include <QTemporaryDir>
+
+#include <QApt/Globals>
+
+class QTimer;
+
+namespace QApt {
+    class Backend;
+    class Package;
+    class Transaction;
+}
+
+/**
+ * Downloads the archives of marked packages into APT's archive cache while
+ * the user is still reviewing changes, so that applying them mostly has to
+ * install. Opt-in through the PrefetchArchives setting.
+ *
+ * Prefetching starts once marking has been idle for a moment and uses the
+ * same download path as "Download Packages From List". When the set of
+ * missing archives changes, the running download is cancelled and restarted
+ * with the new set; archives already in the cache are never fetched again.
+ * Nothing is prefetched while the transaction queue runs an APT item.
+ */
+class ArchivePrefetcher : public QObject
+{
+    Q_OBJECT
+public:
+    static ArchivePrefetcher *instance();
+
+    void setBackend(QApt::Backend *backend);
+
+    /**
+     * Cancels any running prefetch. Called before committing, so the commit
+     * transaction does not queue behind it.
+     */
+    void stop();
+
+    bool isArchiveCached(QApt::Package *package) const;
+    QString archiveDirectory() const;
+
+private:
+    explicit ArchivePrefetcher(QObject *parent = nullptr);
+
+    static ArchivePrefetcher *s_instance;
+
+    QApt::Backend *m_backend;
+    QTimer *m_settleTimer;
+    QPointer<QApt::Transaction> m_trans;
+    // Archive file names the running download was started for
+    QSet<QString> m_fetching;
+    bool m_restartPending;
+    QTemporaryDir m_listDir;
+
+    QSet<QString> missingArchives() const;
+    void start(const QSet<QString> &archives);
+
+private Q_SLOTS:
+    void update();
+    void transactionStatusChanged(QApt::TransactionStatus status);
+};
+
+#endif // ARCHIVEPREFETCHER_H
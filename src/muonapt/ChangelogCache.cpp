@@ -0,0 +1,237 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "ChangelogCache.h"
+
+// Qt includes
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QStandardPaths>
+#include <QtConcurrent>
+
+// KDE includes
+#include <KCompressionDevice>
+#include <KIO/StoredTransferJob>
+
+// QApt includes
+#include <QApt/Package>
+
+// Own includes
+#include "MuonSettings.h"
+
+// Trim the cache back under this size, oldest entries first
+static const qint64 s_maximumCacheSize = 32 * 1024 * 1024;
+
+ChangelogCache *ChangelogCache::s_instance = nullptr;
+
+static QString readCacheFile(const QString &path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return QString();
+    }
+
+    const QString text = QString::fromUtf8(file.readAll());
+
+    // The modification time doubles as the last access time for eviction.
+    // Only works on an open file.
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    file.close();
+    return text;
+}
+
+static void writeCacheFile(const QString &dir, const QString &path, const QByteArray &data)
+{
+    QDir().mkpath(dir);
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Could not write changelog cache file" << path;
+        return;
+    }
+    file.write(data);
+    file.close();
+
+    QDir cacheDir(dir);
+    const QFileInfoList entries = cacheDir.entryInfoList(QDir::Files, QDir::Time);
+    qint64 total = 0;
+    for (const QFileInfo &entry : entries) {
+        total += entry.size();
+        if (total > s_maximumCacheSize) {
+            QFile::remove(entry.absoluteFilePath());
+        }
+    }
+}
+
+static QString readLocalChangelog(const QString &packageName)
+{
+    // Native packages ship changelog.gz instead of changelog.Debian.gz
+    const QString docDir = QStringLiteral("/usr/share/doc/") + packageName;
+    const QStringList candidates = {
+        docDir + QLatin1String("/changelog.Debian.gz"),
+        docDir + QLatin1String("/changelog.gz")
+    };
+
+    for (const QString &path : candidates) {
+        if (!QFile::exists(path)) {
+            continue;
+        }
+
+        KCompressionDevice device(path, KCompressionDevice::GZip);
+        if (device.open(QIODevice::ReadOnly)) {
+            return QString::fromUtf8(device.readAll());
+        }
+    }
+
+    return QString();
+}
+
+ChangelogCache *ChangelogCache::instance()
+{
+    if (!s_instance) {
+        s_instance = new ChangelogCache();
+    }
+    return s_instance;
+}
+
+ChangelogCache::ChangelogCache(QObject *parent)
+    : QObject(parent)
+    , m_cacheDir(QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+                 + QLatin1String("/changelogs"))
+{
+}
+
+QString ChangelogCache::cacheDirectory() const
+{
+    return m_cacheDir;
+}
+
+QUrl ChangelogCache::changelogUrl(QApt::Package *package)
+{
+    QString url = MuonSettings::self()->changelogUrlTemplate().trimmed();
+    if (url.isEmpty()) {
+        return package->changelogUrl();
+    }
+
+    const QString source = package->sourcePackage();
+    // Archive pool layout: "libfoo" sources live under "libf", others under "f"
+    const QString prefix = source.startsWith(QLatin1String("lib")) ? source.left(4) : source.left(1);
+    // Archive file names never carry the epoch
+    QString version = package->availableVersion();
+    version = version.mid(version.indexOf(QLatin1Char(':')) + 1);
+
+    url.replace(QLatin1String("{source}"), source);
+    url.replace(QLatin1String("{prefix}"), prefix);
+    url.replace(QLatin1String("{version}"), version);
+    return QUrl::fromUserInput(url);
+}
+
+QString ChangelogCache::cacheKey(const QString &source, const QString &version) const
+{
+    return source + QLatin1Char('_') + version;
+}
+
+void ChangelogCache::fetch(const QString &source, const QString &version, const QUrl &url)
+{
+    const QString key = cacheKey(source, version);
+    if (m_pending.contains(key)) {
+        return;
+    }
+    m_pending.insert(key);
+
+    const QString path = m_cacheDir + QLatin1Char('/') + key;
+    auto *watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher, source, version, url]() {
+        const QString text = watcher->result();
+        watcher->deleteLater();
+
+        if (text.isEmpty()) {
+            download(source, version, url);
+        } else {
+            finish(source, version, text);
+        }
+    });
+    watcher->setFuture(QtConcurrent::run(readCacheFile, path));
+}
+
+void ChangelogCache::fetchLocal(const QString &packageName, const QString &source,
+                                const QString &installedVersion)
+{
+    const QString key = cacheKey(source, installedVersion);
+    if (m_pending.contains(key)) {
+        return;
+    }
+    m_pending.insert(key);
+
+    auto *watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher, source, installedVersion]() {
+        const QString text = watcher->result();
+        watcher->deleteLater();
+        finish(source, installedVersion, text);
+    });
+    watcher->setFuture(QtConcurrent::run(readLocalChangelog, packageName));
+}
+
+void ChangelogCache::download(const QString &source, const QString &version, const QUrl &url)
+{
+    if (!url.isValid()) {
+        finish(source, version, QString());
+        return;
+    }
+
+    KIO::StoredTransferJob *job = KIO::storedGet(url, KIO::NoReload, KIO::HideProgressInfo);
+    connect(job, &KJob::result, this, [this, job, source, version]() {
+        if (job->error()) {
+            finish(source, version, QString());
+            return;
+        }
+
+        const QByteArray data = job->data();
+        const QString dir = m_cacheDir;
+        const QString path = dir + QLatin1Char('/') + cacheKey(source, version);
+        QtConcurrent::run(writeCacheFile, dir, path, data);
+
+        finish(source, version, QString::fromUtf8(data));
+    });
+}
+
+void ChangelogCache::finish(const QString &source, const QString &version, const QString &text)
+{
+    if (text.isEmpty()) {
+        m_pending.remove(cacheKey(source, version));
+        emit changelogFailed(source, version);
+        return;
+    }
+
+    // Parsing big changelogs is noticeable, keep it off the GUI thread
+    typedef QSharedPointer<QApt::Changelog> ChangelogPointer;
+    auto *watcher = new QFutureWatcher<ChangelogPointer>(this);
+    connect(watcher, &QFutureWatcher<ChangelogPointer>::finished, this, [this, watcher, source, version]() {
+        m_pending.remove(cacheKey(source, version));
+        emit changelogReady(source, version, *watcher->result());
+        watcher->deleteLater();
+    });
+    watcher->setFuture(QtConcurrent::run([text, source]() {
+        return ChangelogPointer(new QApt::Changelog(text, source));
+    }));
+}
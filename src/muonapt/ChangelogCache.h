@@ -0,0 +1,90 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef CHANGELOGCACHE_H
+#define CHANGELOGCACHE_H
+
+#include <QObject>
+#include <QSet>
+#include <QUrl>
+
+#include <QApt/Changelog>
+
+namespace QApt {
+    class Package;
+}
+
+/**
+ * Persistent changelog cache keyed by source package and version.
+ *
+ * Downloaded changelogs are kept in the user's cache directory and trimmed
+ * least recently used first once the cache grows beyond its size limit.
+ * Installed packages can be served from the changelog dpkg put into
+ * /usr/share/doc without touching the network. Reading, writing and parsing
+ * happen on worker threads; results are delivered on the GUI thread.
+ */
+class ChangelogCache : public QObject
+{
+    Q_OBJECT
+public:
+    static ChangelogCache *instance();
+
+    /**
+     * Fetches the changelog of @p source at @p version, from the disk cache
+     * when possible and otherwise from @p url.
+     * Emits changelogReady() or changelogFailed() when done.
+     */
+    void fetch(const QString &source, const QString &version, const QUrl &url);
+
+    /**
+     * Reads the changelog shipped with the installed @p packageName, which
+     * describes @p installedVersion of @p source.
+     * Emits changelogReady() or changelogFailed() when done.
+     */
+    void fetchLocal(const QString &packageName, const QString &source, const QString &installedVersion);
+
+    QString cacheDirectory() const;
+
+    /**
+     * @returns where to fetch the changelog of the candidate version of
+     * @p package from: the configured URL template when there is one, so a
+     * local mirror or file: URLs can be used, otherwise the package's own.
+     */
+    static QUrl changelogUrl(QApt::Package *package);
+
+private:
+    explicit ChangelogCache(QObject *parent = nullptr);
+
+    static ChangelogCache *s_instance;
+
+    QString m_cacheDir;
+    // Keys of fetches in flight, so concurrent requests share one download
+    QSet<QString> m_pending;
+
+    QString cacheKey(const QString &source, const QString &version) const;
+    void download(const QString &source, const QString &version, const QUrl &url);
+    void finish(const QString &source, const QString &version, const QString &text);
+
+Q_SIGNALS:
+    void changelogReady(const QString &source, const QString &version, const QApt::Changelog &changelog);
+    void changelogFailed(const QString &source, const QString &version);
+};
+
+#endif // CHANGELOGCACHE_H
@@ -33,7 +33,8 @@
 // Own includes
 #include "muonapt/MuonStrings.h"
 
-ChangesDialog::ChangesDialog(QWidget *parent, const QApt::StateChanges &changes)
+ChangesDialog::ChangesDialog(QWidget *parent, const QApt::StateChanges &changes,
+                             const QMap<QString, QString> &failures)
     : QDialog(parent)
 {
     setWindowTitle(i18nc("@title:window", "Confirm Additional Changes"));
@@ -49,6 +50,22 @@ ChangesDialog::ChangesDialog(QWidget *parent, const QApt::StateChanges &changes)
                          "This action requires changes to other packages:",
                          count));
 
+    if (!failures.isEmpty()) {
+        if (count == 0) {
+            setWindowTitle(i18nc("@title:window", "Unable to Mark Packages"));
+            headerLabel->setText(i18nc("@info", "<h2>Some packages could not be marked</h2>"));
+            label->setText(i18ncp("@label", "The following package could not be marked:",
+                                  "The following packages could not be marked:",
+                                  failures.size()));
+        } else {
+            label->setText(i18ncp("@label", "%1 package could not be marked. "
+                                  "The others require changes to other packages:",
+                                  "%1 packages could not be marked. "
+                                  "The others require changes to other packages:",
+                                  failures.size()));
+        }
+    }
+
     QTreeView *packageView = new QTreeView(this);
     packageView->setHeaderHidden(true);
     packageView->setRootIsDecorated(false);
@@ -78,8 +95,12 @@ ChangesDialog::ChangesDialog(QWidget *parent, const QApt::StateChanges &changes)
     bottomLayout->addWidget(okButton);
     bottomLayout->addWidget(cancelButton);
 
+    // Nothing to confirm, only something to acknowledge
+    cancelButton->setVisible(count > 0);
+
     m_model = new QStandardItemModel(this);
     packageView->setModel(m_model);
+    addFailures(failures);
     addPackages(changes);
     packageView->expandAll();
     packageView->setEditTriggers(QAbstractItemView::NoEditTriggers);
@@ -90,6 +111,31 @@ ChangesDialog::ChangesDialog(QWidget *parent, const QApt::StateChanges &changes)
     layout->addWidget(bottomBox);
 }
 
+void ChangesDialog::addFailures(const QMap<QString, QString> &failures)
+{
+    if (failures.isEmpty()) {
+        return;
+    }
+
+    QStandardItem *root = new QStandardItem;
+    root->setText(i18nc("@item:inlistbox", "Could not be marked"));
+
+    QFont font = root->font();
+    font.setBold(true);
+    root->setFont(font);
+
+    for (auto i = failures.constBegin(); i != failures.constEnd(); ++i) {
+        QStandardItem *item = new QStandardItem(QIcon::fromTheme("dialog-error"), i.key());
+        if (!i.value().isEmpty()) {
+            item->setToolTip(i.value());
+            item->appendRow(new QStandardItem(i.value().trimmed()));
+        }
+        root->appendRow(item);
+    }
+
+    m_model->appendRow(root);
+}
+
 void ChangesDialog::addPackages(const QApt::StateChanges &changes)
 {
     for (auto i = changes.constBegin(); i != changes.constEnd(); ++i) {
@@ -24,6 +24,7 @@
 // Qt includes
 #include <QStandardItemModel>
 #include <QDialog>
+#include <QMap>
 
 // QApt includes
 #include <QApt/Package>
@@ -33,11 +34,17 @@ class QStandardItemModel;
 class ChangesDialog : public QDialog
 {
 public:
-    ChangesDialog(QWidget *parent, const QApt::StateChanges &changes);
+    /**
+     * @param failures reasons by package name for packages that could not
+     * be marked, listed above the additional changes
+     */
+    ChangesDialog(QWidget *parent, const QApt::StateChanges &changes,
+                  const QMap<QString, QString> &failures = QMap<QString, QString>());
 
 private:
     QStandardItemModel *m_model;
 
+    void addFailures(const QMap<QString, QString> &failures);
     void addPackages(const QApt::StateChanges &changes);
     int countChanges(const QApt::StateChanges &changes);
 };
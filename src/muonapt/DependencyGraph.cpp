@@ -0,0 +1,477 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "DependencyGraph.h"
+
+// Qt includes
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QStringBuilder>
+#include <QTimer>
+#include <QtConcurrent>
+
+// QApt includes
+#include <QApt/Backend>
+#include <QApt/DependencyInfo>
+#include <QApt/Package>
+
+DependencyGraph *DependencyGraph::s_instance = nullptr;
+
+int DependencyGraphData::nodeOf(QApt::Package *package) const
+{
+    const int id = package->id();
+    if (id >= 0 && id < idIndex.size()) {
+        return idIndex.at(id);
+    }
+    return -1;
+}
+
+DependencyGraphData::EdgeRange DependencyGraphData::dependencies(int node) const
+{
+    const quint32 begin = forwardOffsets.at(node);
+    const quint32 end = forwardOffsets.at(node + 1);
+    return { forwardTargets.constData() + begin, forwardFlags.constData() + begin, int(end - begin) };
+}
+
+DependencyGraphData::EdgeRange DependencyGraphData::dependants(int node) const
+{
+    const quint32 begin = reverseOffsets.at(node);
+    const quint32 end = reverseOffsets.at(node + 1);
+    return { reverseTargets.constData() + begin, reverseFlags.constData() + begin, int(end - begin) };
+}
+
+bool DependencyGraphData::isSatisfiedByInstalled(quint32 node) const
+{
+    if (int(node) < packageCount) {
+        return installed.testBit(node);
+    }
+
+    for (quint32 provider : providers.value(node)) {
+        if (installed.testBit(provider)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+int DependencyGraphData::pickAlternative(const quint32 *targets, int count, const QBitArray &visited) const
+{
+    // Already pulled in through another path: nothing new to add
+    for (int i = 0; i < count; ++i) {
+        if (visited.testBit(targets[i])) {
+            return -1;
+        }
+    }
+
+    for (int i = 0; i < count; ++i) {
+        if (isSatisfiedByInstalled(targets[i])) {
+            return targets[i];
+        }
+    }
+
+    for (int i = 0; i < count; ++i) {
+        if (int(targets[i]) < packageCount || providers.contains(targets[i])) {
+            return targets[i];
+        }
+    }
+
+    // Nothing can satisfy the group; report the first alternative
+    return targets[0];
+}
+
+QVector<DependencyGraphData::Dependant> DependencyGraphData::dependantList(int node) const
+{
+    QVector<Dependant> list;
+    const EdgeRange edges = dependants(node);
+    list.reserve(edges.count);
+    for (int i = 0; i < edges.count; ++i) {
+        const Dependant dependant = { int(edges.targets[i]), edgeType(edges.flags[i]) };
+        // Versioned relations can list the same package more than once
+        if (!list.isEmpty() && list.last().node == dependant.node && list.last().type == dependant.type) {
+            continue;
+        }
+        list.append(dependant);
+    }
+    return list;
+}
+
+DependencyGraphData::Closure DependencyGraphData::closure(int node, bool withRecommends) const
+{
+    const qint64 key = (qint64(node) << 1) | (withRecommends ? 1 : 0);
+    {
+        QMutexLocker locker(&m_closureMutex);
+        auto it = m_closures.constFind(key);
+        if (it != m_closures.constEnd()) {
+            return it.value();
+        }
+    }
+
+    Closure result;
+    result.node = node;
+
+    QBitArray visited(nodeCount());
+    QVector<quint32> queue;
+    queue.append(node);
+    visited.setBit(node);
+
+    for (int head = 0; head < queue.size(); ++head) {
+        const quint32 current = queue.at(head);
+
+        if (int(current) >= packageCount) {
+            // Virtual package: stands for one of its providers
+            const QVector<quint32> candidates = providers.value(current);
+            if (candidates.isEmpty()) {
+                ++result.unresolvedCount;
+                continue;
+            }
+            const int provider = pickAlternative(candidates.constData(), candidates.size(), visited);
+            if (provider != -1) {
+                visited.setBit(provider);
+                queue.append(provider);
+            }
+            continue;
+        }
+
+        if (int(current) != node) {
+            ++result.dependencyCount;
+        }
+        if (!installed.testBit(current)) {
+            ++result.newPackageCount;
+            result.downloadSize += downloadSizes.at(current);
+            result.installedSize += installedSizes.at(current);
+        }
+
+        const EdgeRange edges = dependencies(current);
+        int groupStart = 0;
+        for (int i = 0; i < edges.count; ++i) {
+            if (edges.flags[i] & OrContinues) {
+                continue;
+            }
+
+            // [groupStart, i] is one or-group
+            const int type = edgeType(edges.flags[groupStart]);
+            const int groupSize = i - groupStart + 1;
+            const quint32 *group = edges.targets + groupStart;
+            groupStart = i + 1;
+
+            if (type != QApt::Depends && type != QApt::PreDepends
+                    && !(withRecommends && type == QApt::Recommends)) {
+                continue;
+            }
+
+            const int target = pickAlternative(group, groupSize, visited);
+            if (target != -1) {
+                visited.setBit(target);
+                queue.append(target);
+            }
+        }
+    }
+
+    QMutexLocker locker(&m_closureMutex);
+    m_closures.insert(key, result);
+    return result;
+}
+
+static QString nodeKey(QApt::Package *package)
+{
+    // Dependencies name native packages without an architecture qualifier
+    if (package->isForeignArch()) {
+        return package->name() % QLatin1Char(':') % package->architecture();
+    }
+    return package->name();
+}
+
+// Reading relations goes through QApt's shared record parser, so it is done
+// on the GUI thread in slices; the first pass over the packages creates the
+// nodes, the second adds their edges
+struct DependencyGraph::Build
+{
+    ~Build() { delete data; }
+
+    DependencyGraphData *data = nullptr;
+    QApt::PackageList packages;
+    int next = 0;
+    QElapsedTimer elapsed;
+
+    // The edges as (source, target, flags), laid out when all are known
+    QVector<quint32> sources;
+    QVector<quint32> targets;
+    QVector<quint8> flags;
+
+    int resolve(QString name);
+    void addNode(int node);
+    void addEdges(int source, const QList<QApt::DependencyItem> &items, QApt::DependencyType type);
+    void addRelations(int node);
+};
+
+int DependencyGraph::Build::resolve(QString name)
+{
+    if (name.endsWith(QLatin1String(":any"))) {
+        name.chop(4);
+    }
+    int node = data->nameIndex.value(name, -1);
+    if (node == -1) {
+        // Virtual package, or one not available from any source
+        node = data->names.size();
+        data->names.append(name);
+        data->nameIndex.insert(name, node);
+    }
+    return node;
+}
+
+void DependencyGraph::Build::addNode(int node)
+{
+    QApt::Package *package = packages.at(node);
+    const QString key = nodeKey(package);
+    data->names.append(key);
+    data->nameIndex.insert(key, node);
+    data->idIndex[package->id()] = node;
+
+    data->installed.setBit(node, package->isInstalled());
+    data->downloadSizes[node] = package->downloadSize();
+    data->installedSizes[node] = package->availableInstalledSize();
+}
+
+void DependencyGraph::Build::addEdges(int source, const QList<QApt::DependencyItem> &items, QApt::DependencyType type)
+{
+    for (const QApt::DependencyItem &item : items) {
+        for (int i = 0; i < item.size(); ++i) {
+            quint8 edgeFlags = quint8(type) & DependencyGraphData::TypeMask;
+            if (i < item.size() - 1) {
+                edgeFlags |= DependencyGraphData::OrContinues;
+            }
+            sources.append(source);
+            targets.append(resolve(item.at(i).packageName()));
+            flags.append(edgeFlags);
+        }
+    }
+}
+
+void DependencyGraph::Build::addRelations(int node)
+{
+    QApt::Package *package = packages.at(node);
+    addEdges(node, package->preDepends(), QApt::PreDepends);
+    addEdges(node, package->depends(), QApt::Depends);
+    addEdges(node, package->recommends(), QApt::Recommends);
+    addEdges(node, package->suggests(), QApt::Suggests);
+    addEdges(node, package->enhances(), QApt::Enhances);
+    addEdges(node, package->conflicts(), QApt::Conflicts);
+    addEdges(node, package->breaks(), QApt::Breaks);
+    addEdges(node, package->replaces(), QApt::Replaces);
+
+    for (const QString &provided : package->providesList()) {
+        const int virtualNode = resolve(provided);
+        if (virtualNode >= packages.size()) {
+            data->providers[virtualNode].append(node);
+        }
+    }
+}
+
+// Counting sort of the edges by source, then by target for the reverse
+// direction. Edges keep their gathering order within a node. Needs no QApt.
+static DependencyGraphSnapshot layoutGraph(DependencyGraphData *data, const QVector<quint32> &sources,
+                                           const QVector<quint32> &targets, const QVector<quint8> &flags)
+{
+    const int nodeCount = data->names.size();
+    const int edgeCount = sources.size();
+
+    data->forwardOffsets.fill(0, nodeCount + 1);
+    data->reverseOffsets.fill(0, nodeCount + 1);
+    for (int e = 0; e < edgeCount; ++e) {
+        ++data->forwardOffsets[sources.at(e) + 1];
+        ++data->reverseOffsets[targets.at(e) + 1];
+    }
+    for (int n = 0; n < nodeCount; ++n) {
+        data->forwardOffsets[n + 1] += data->forwardOffsets.at(n);
+        data->reverseOffsets[n + 1] += data->reverseOffsets.at(n);
+    }
+
+    data->forwardTargets.resize(edgeCount);
+    data->forwardFlags.resize(edgeCount);
+    data->reverseTargets.resize(edgeCount);
+    data->reverseFlags.resize(edgeCount);
+
+    QVector<quint32> forwardFill = data->forwardOffsets;
+    QVector<quint32> reverseFill = data->reverseOffsets;
+    for (int e = 0; e < edgeCount; ++e) {
+        const quint32 f = forwardFill[sources.at(e)]++;
+        data->forwardTargets[f] = targets.at(e);
+        data->forwardFlags[f] = flags.at(e);
+
+        const quint32 r = reverseFill[targets.at(e)]++;
+        data->reverseTargets[r] = sources.at(e);
+        // Alternatives only make sense looking forward
+        data->reverseFlags[r] = flags.at(e) & DependencyGraphData::TypeMask;
+    }
+
+    return DependencyGraphSnapshot(data);
+}
+
+DependencyGraph *DependencyGraph::instance()
+{
+    if (!s_instance) {
+        s_instance = new DependencyGraph();
+    }
+    return s_instance;
+}
+
+DependencyGraph::DependencyGraph(QObject *parent)
+    : QObject(parent)
+    , m_backend(nullptr)
+    , m_build(nullptr)
+    , m_buildTimer(new QTimer(this))
+    , m_watcher(new QFutureWatcher<DependencyGraphSnapshot>(this))
+    , m_generation(0)
+{
+    // Slices run whenever no other events are pending
+    m_buildTimer->setInterval(0);
+    connect(m_buildTimer, &QTimer::timeout, this, &DependencyGraph::buildSlice);
+    connect(m_watcher, &QFutureWatcher<DependencyGraphSnapshot>::finished,
+            this, &DependencyGraph::buildFinished);
+}
+
+DependencyGraph::~DependencyGraph()
+{
+    delete m_build;
+    m_watcher->waitForFinished();
+}
+
+void DependencyGraph::setBackend(QApt::Backend *backend)
+{
+    if (m_backend) {
+        disconnect(m_backend, nullptr, this, nullptr);
+    }
+
+    m_backend = backend;
+    connect(m_backend, &QApt::Backend::cacheReloadStarted, this, &DependencyGraph::invalidate);
+    connect(m_backend, &QApt::Backend::cacheReloadFinished, this, &DependencyGraph::rebuild);
+
+    rebuild();
+}
+
+DependencyGraphSnapshot DependencyGraph::snapshot() const
+{
+    return m_snapshot;
+}
+
+bool DependencyGraph::isReady() const
+{
+    return !m_snapshot.isNull();
+}
+
+quint32 DependencyGraph::generation() const
+{
+    return m_generation;
+}
+
+void DependencyGraph::invalidate()
+{
+    // The package pointers a build in progress works on are about to go away
+    ++m_generation;
+    m_snapshot.reset();
+    m_buildTimer->stop();
+    delete m_build;
+    m_build = nullptr;
+}
+
+void DependencyGraph::rebuild()
+{
+    if (!m_backend) {
+        return;
+    }
+
+    invalidate();
+
+    m_build = new Build;
+    m_build->elapsed.start();
+    m_build->packages = m_backend->availablePackages();
+
+    const int packageCount = m_build->packages.size();
+    DependencyGraphData *data = new DependencyGraphData;
+    data->generation = m_generation;
+    data->packageCount = packageCount;
+    data->names.reserve(packageCount);
+    data->nameIndex.reserve(packageCount);
+    data->installed.resize(packageCount);
+    data->downloadSizes.resize(packageCount);
+    data->installedSizes.resize(packageCount);
+
+    int maxId = -1;
+    for (QApt::Package *package : m_build->packages) {
+        maxId = qMax(maxId, package->id());
+    }
+    data->idIndex.fill(-1, maxId + 1);
+    m_build->data = data;
+
+    m_buildTimer->start();
+}
+
+void DependencyGraph::buildSlice()
+{
+    // Short enough not to delay input or painting noticeably
+    static const int s_sliceBudgetMs = 8;
+
+    QElapsedTimer slice;
+    slice.start();
+
+    const int packageCount = m_build->packages.size();
+    while (m_build->next < 2 * packageCount && slice.elapsed() < s_sliceBudgetMs) {
+        if (m_build->next < packageCount) {
+            m_build->addNode(m_build->next);
+        } else {
+            m_build->addRelations(m_build->next - packageCount);
+        }
+        ++m_build->next;
+    }
+
+    if (m_build->next < 2 * packageCount) {
+        return;
+    }
+
+    m_buildTimer->stop();
+    qDebug() << "Read the relations of" << packageCount << "packages in"
+             << m_build->elapsed.elapsed() << "ms";
+
+    DependencyGraphData *data = m_build->data;
+    m_build->data = nullptr;
+    const QVector<quint32> sources = m_build->sources;
+    const QVector<quint32> targets = m_build->targets;
+    const QVector<quint8> flags = m_build->flags;
+    delete m_build;
+    m_build = nullptr;
+
+    m_watcher->setFuture(QtConcurrent::run([data, sources, targets, flags]() {
+        return layoutGraph(data, sources, targets, flags);
+    }));
+}
+
+void DependencyGraph::buildFinished()
+{
+    DependencyGraphSnapshot result = m_watcher->result();
+    if (!result || result->generation != m_generation) {
+        return;
+    }
+
+    qDebug() << "Built dependency graph:" << result->nodeCount() << "nodes,"
+             << result->forwardTargets.size() << "edges";
+
+    m_snapshot = result;
+    emit ready();
+}
@@ -0,0 +1,188 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef DEPENDENCYGRAPH_H
+#define DEPENDENCYGRAPH_H
+
+#include <QObject>
+#include <QBitArray>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QVector>
+
+class QTimer;
+
+namespace QApt {
+    class Backend;
+    class Package;
+}
+
+/**
+ * Immutable snapshot of the dependency relations of the candidate versions
+ * in the APT cache.
+ *
+ * Nodes are dense indexes: the available packages first, followed by names
+ * that only appear as dependency targets (virtual packages). Forward and
+ * reverse edges are stored in compressed sparse row form, so the edges of a
+ * node are one contiguous slice that can be walked without allocating.
+ */
+class DependencyGraphData
+{
+public:
+    enum EdgeFlag {
+        // Lower bits hold the QApt::DependencyType of the edge
+        TypeMask = 0x0f,
+        // Set on forward edges followed by another alternative of the
+        // same or-group ("a | b")
+        OrContinues = 0x80
+    };
+
+    struct EdgeRange {
+        const quint32 *targets;
+        const quint8 *flags;
+        int count;
+    };
+
+    // What marking a package for installation would pull in
+    struct Closure {
+        int node = -1;
+        // Packages in the closure, not counting the root
+        int dependencyCount = 0;
+        // Packages in the closure, root included, that are not installed yet
+        int newPackageCount = 0;
+        qint64 downloadSize = 0;
+        qint64 installedSize = 0;
+        // Dependencies nothing available can satisfy
+        int unresolvedCount = 0;
+    };
+
+    quint32 generation = 0;
+    int packageCount = 0;
+
+    int nodeCount() const { return names.size(); }
+    int nodeOf(const QString &name) const { return nameIndex.value(name, -1); }
+    int nodeOf(QApt::Package *package) const;
+    QString nodeName(int node) const { return names.at(node); }
+
+    static int edgeType(quint8 flags) { return flags & TypeMask; }
+
+    EdgeRange dependencies(int node) const;
+    EdgeRange dependants(int node) const;
+
+    struct Dependant {
+        int node;
+        int type;
+    };
+    /// The dependants of @p node, each package listed once per dependency type
+    QVector<Dependant> dependantList(int node) const;
+
+    /**
+     * Computes the transitive Depends/Pre-Depends closure of @p node, also
+     * following Recommends when @p withRecommends is set. Of the alternatives
+     * of an or-group the first installed one wins, otherwise the first
+     * available one, which is what APT does when nothing else is marked.
+     *
+     * Results are memoized for the lifetime of the snapshot. Closures of the
+     * packages met on the way are not reused, as the alternatives picked
+     * depend on what was visited before. Thread-safe.
+     */
+    Closure closure(int node, bool withRecommends) const;
+
+    QVector<QString> names;
+    QHash<QString, int> nameIndex;
+    // QApt package id -> node, -1 for ids that are not available packages
+    QVector<int> idIndex;
+
+    QVector<quint32> forwardOffsets;
+    QVector<quint32> forwardTargets;
+    QVector<quint8> forwardFlags;
+
+    QVector<quint32> reverseOffsets;
+    QVector<quint32> reverseTargets;
+    QVector<quint8> reverseFlags;
+
+    // Per package node data
+    QBitArray installed;
+    QVector<qint64> downloadSizes;
+    QVector<qint64> installedSizes;
+
+    // Virtual package node -> nodes of the packages providing it
+    QHash<quint32, QVector<quint32>> providers;
+
+private:
+    int pickAlternative(const quint32 *targets, int count, const QBitArray &visited) const;
+    bool isSatisfiedByInstalled(quint32 node) const;
+
+    mutable QMutex m_closureMutex;
+    mutable QHash<qint64, Closure> m_closures;
+};
+
+typedef QSharedPointer<const DependencyGraphData> DependencyGraphSnapshot;
+
+/**
+ * Builds the dependency graph whenever the APT cache is (re)loaded and hands
+ * out snapshots scoped to that cache generation.
+ *
+ * QApt is not thread-safe, so the relations are read on the GUI thread a
+ * few milliseconds at a time while the event loop is idle. Only laying out
+ * the edges, which needs no QApt, happens on a worker thread.
+ */
+class DependencyGraph : public QObject
+{
+    Q_OBJECT
+public:
+    static DependencyGraph *instance();
+
+    void setBackend(QApt::Backend *backend);
+
+    // Null until the first build for the current cache has finished
+    DependencyGraphSnapshot snapshot() const;
+    bool isReady() const;
+    quint32 generation() const;
+
+private:
+    explicit DependencyGraph(QObject *parent = nullptr);
+    ~DependencyGraph();
+
+    static DependencyGraph *s_instance;
+
+    struct Build;
+
+    QApt::Backend *m_backend;
+    DependencyGraphSnapshot m_snapshot;
+    // The build reading relations, null when none is
+    Build *m_build;
+    QTimer *m_buildTimer;
+    QFutureWatcher<DependencyGraphSnapshot> *m_watcher;
+    quint32 m_generation;
+
+private Q_SLOTS:
+    void invalidate();
+    void rebuild();
+    void buildSlice();
+    void buildFinished();
+
+Q_SIGNALS:
+    void ready();
+};
+
+#endif // DEPENDENCYGRAPH_H
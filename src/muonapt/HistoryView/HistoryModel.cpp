@@ -0,0 +1,332 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "HistoryModel.h"
+
+#include <QtCore/QBuffer>
+#include <QtCore/QDebug>
+#include <QtCore/QDir>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFile>
+#include <QtCore/QFileInfo>
+#include <QtCore/QFileSystemWatcher>
+#include <QtCore/QLocale>
+#include <QtCore/QTimer>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <KCompressionDevice>
+#include <KLocalizedString>
+
+#include "HistoryProxyModel.h"
+
+// Top level rows have no parent; a change row's internal id identifies its
+// day, counted from s_firstDayId so that it stays put when newer days come in
+static const quintptr s_dayId = 0;
+static const quintptr s_firstDayId = quintptr(1) << 30;
+
+HistoryModel::HistoryModel(QObject *parent)
+    : QAbstractItemModel(parent)
+    , m_itemIcon(QIcon::fromTheme("applications-other"))
+    , m_cancelled(0)
+    , m_watcher(nullptr)
+    , m_tailTimer(new QTimer(this))
+    , m_newerDays(0)
+{
+    // APT writes a transaction in a few bursts
+    m_tailTimer->setInterval(200);
+    m_tailTimer->setSingleShot(true);
+    connect(m_tailTimer, &QTimer::timeout, this, &HistoryModel::readNewer);
+
+    // In HistoryStore::Action order
+    m_actionNames << i18nc("@info:status describes a past-tense action", "Installed")
+                  << i18nc("@info:status describes a past-tense action", "Upgraded")
+                  << i18nc("@status describes a past-tense action", "Downgraded")
+                  << i18nc("@status describes a past-tense action", "Removed")
+                  << i18nc("@status describes a past-tense action", "Purged");
+}
+
+HistoryModel::~HistoryModel()
+{
+    m_cancelled.storeRelease(1);
+    m_loadFuture.waitForFinished();
+}
+
+void HistoryModel::load(const QString &directory)
+{
+    m_directory = directory;
+    const QString current = currentLog();
+    m_loadFuture = QtConcurrent::run([this, directory, current]() {
+        QElapsedTimer timer;
+        timer.start();
+
+        const QStringList files = HistoryStore::logFiles(directory);
+        for (const QString &path : files) {
+            if (m_cancelled.loadAcquire()) {
+                return;
+            }
+
+            if (path == current) {
+                // Only finished transactions, the tail picks up the rest
+                QByteArray log;
+                const quint64 inode = LogTail::readLog(path, 0, &log);
+                if (!inode) {
+                    qWarning() << "Cannot read APT history log" << path;
+                    continue;
+                }
+
+                log.truncate(HistoryStore::completeLength(log));
+                QBuffer buffer(&log);
+                buffer.open(QIODevice::ReadOnly);
+                const HistoryStore older = HistoryStore::parse(&buffer);
+                const qint64 offset = log.size();
+                QMetaObject::invokeMethod(this, [this, older, inode, offset]() {
+                    if (!older.isEmpty()) {
+                        appendOlder(older);
+                    }
+                    startTail(inode, offset);
+                }, Qt::QueuedConnection);
+                continue;
+            }
+
+            KCompressionDevice device(path, path.endsWith(QLatin1String(".gz"))
+                                      ? KCompressionDevice::GZip : KCompressionDevice::None);
+            if (!device.open(QIODevice::ReadOnly)) {
+                qWarning() << "Cannot read APT history log" << path;
+                continue;
+            }
+
+            const HistoryStore older = HistoryStore::parse(&device);
+            if (!older.isEmpty()) {
+                QMetaObject::invokeMethod(this, [this, older]() {
+                    appendOlder(older);
+                }, Qt::QueuedConnection);
+            }
+        }
+
+        if (!files.contains(current)) {
+            // Follow the log once APT creates it
+            QMetaObject::invokeMethod(this, [this]() {
+                startTail(0, 0);
+            }, Qt::QueuedConnection);
+        }
+
+        qDebug() << "APT history of" << files.size() << "logs parsed in" << timer.elapsed() << "ms";
+    });
+}
+
+void HistoryModel::appendOlder(const HistoryStore &older)
+{
+    int firstDay = 0;
+
+    // A day may span two logs
+    const int lastDay = m_store.dayCount() - 1;
+    if (lastDay >= 0 && m_store.dayDate(lastDay) == older.dayDate(0)) {
+        const int count = m_store.dayChangeCount(lastDay);
+        beginInsertRows(index(lastDay, 0), count, count + older.dayChangeCount(0) - 1);
+        m_store.appendOlder(older, 0, 1);
+        endInsertRows();
+        firstDay = 1;
+    }
+
+    if (firstDay < older.dayCount()) {
+        const int count = m_store.dayCount();
+        beginInsertRows(QModelIndex(), count, count + older.dayCount() - firstDay - 1);
+        m_store.appendOlder(older, firstDay, older.dayCount());
+        endInsertRows();
+    }
+}
+
+void HistoryModel::prependNewer(const HistoryStore &newer)
+{
+    int lastDay = newer.dayCount();
+
+    // A day may continue in the newer transactions
+    if (m_store.dayCount() > 0 && m_store.dayDate(0) == newer.dayDate(lastDay - 1)) {
+        beginInsertRows(index(0, 0), 0, newer.dayChangeCount(lastDay - 1) - 1);
+        m_store.prependNewer(newer, lastDay - 1, lastDay);
+        endInsertRows();
+        --lastDay;
+    }
+
+    if (lastDay > 0) {
+        beginInsertRows(QModelIndex(), 0, lastDay - 1);
+        m_store.prependNewer(newer, 0, lastDay);
+        m_newerDays += lastDay;
+        endInsertRows();
+    }
+}
+
+QString HistoryModel::currentLog() const
+{
+    return QDir(m_directory).filePath(QStringLiteral("history.log"));
+}
+
+void HistoryModel::startTail(quint64 inode, qint64 offset)
+{
+    m_tail.inode = inode;
+    m_tail.offset = offset;
+
+    m_watcher = new QFileSystemWatcher(this);
+    // The directory tells about the log being created or rotated, the file about writes
+    m_watcher->addPath(m_directory);
+    connect(m_watcher, &QFileSystemWatcher::directoryChanged, m_tailTimer, QOverload<>::of(&QTimer::start));
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, m_tailTimer, QOverload<>::of(&QTimer::start));
+    watchLog();
+
+    // Catch up with anything written while the logs were parsed
+    readNewer();
+}
+
+void HistoryModel::watchLog()
+{
+    // The watch is lost when the log is rotated away
+    const QString log = currentLog();
+    if (!m_watcher->files().contains(log) && QFile::exists(log)) {
+        m_watcher->addPath(log);
+    }
+}
+
+void HistoryModel::readNewer()
+{
+    const QString log = currentLog();
+    watchLog();
+
+    QByteArray data = LogTail::readAppended(log, &m_tail, HistoryStore::completeLength);
+    if (data.isEmpty()) {
+        return;
+    }
+
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::ReadOnly);
+    const HistoryStore newer = HistoryStore::parse(&buffer);
+    if (!newer.isEmpty()) {
+        prependNewer(newer);
+    }
+}
+
+const HistoryStore &HistoryModel::store() const
+{
+    return m_store;
+}
+
+int HistoryModel::changeAt(const QModelIndex &index) const
+{
+    if (!index.isValid() || index.internalId() == s_dayId) {
+        return -1;
+    }
+    return m_store.dayFirstChange(dayAt(index.internalId())) + index.row();
+}
+
+QModelIndex HistoryModel::index(int row, int column, const QModelIndex &parent) const
+{
+    if (row < 0 || column != 0) {
+        return QModelIndex();
+    }
+
+    if (!parent.isValid()) {
+        return row < m_store.dayCount() ? createIndex(row, column, s_dayId) : QModelIndex();
+    }
+
+    if (parent.internalId() != s_dayId || row >= m_store.dayChangeCount(parent.row())) {
+        return QModelIndex();
+    }
+    return createIndex(row, column, dayId(parent.row()));
+}
+
+quintptr HistoryModel::dayId(int day) const
+{
+    return s_firstDayId + quintptr(day) - quintptr(m_newerDays);
+}
+
+int HistoryModel::dayAt(quintptr id) const
+{
+    return int(id - s_firstDayId) + m_newerDays;
+}
+
+QModelIndex HistoryModel::parent(const QModelIndex &index) const
+{
+    if (!index.isValid() || index.internalId() == s_dayId) {
+        return QModelIndex();
+    }
+    return createIndex(dayAt(index.internalId()), 0, s_dayId);
+}
+
+int HistoryModel::rowCount(const QModelIndex &parent) const
+{
+    if (!parent.isValid()) {
+        return m_store.dayCount();
+    }
+    if (parent.internalId() == s_dayId) {
+        return m_store.dayChangeCount(parent.row());
+    }
+    return 0;
+}
+
+int HistoryModel::columnCount(const QModelIndex &parent) const
+{
+    Q_UNUSED(parent)
+    return 1;
+}
+
+QVariant HistoryModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid()) {
+        return QVariant();
+    }
+
+    if (index.internalId() == s_dayId) {
+        const QDate date = m_store.dayDate(index.row());
+        switch (role) {
+        case Qt::DisplayRole:
+            return QLocale().toString(date, QLocale::ShortFormat);
+        case HistoryProxyModel::HistoryDateRole:
+            // The newest change of the day
+            return m_store.changeTime(m_store.dayFirstChange(index.row()));
+        }
+        return QVariant();
+    }
+
+    const int day = dayAt(index.internalId());
+    const int change = m_store.dayFirstChange(day) + index.row();
+    switch (role) {
+    case Qt::DisplayRole:
+        return i18nc("@item example: muon installed at 16:00", "%1 %2 at %3",
+                     m_store.changePackage(change),
+                     m_actionNames.at(m_store.changeAction(change)),
+                     m_store.changeTime(change).toString());
+    case Qt::DecorationRole:
+        return m_itemIcon;
+    case PackageRole:
+        return m_store.changePackage(change);
+    case HistoryProxyModel::HistoryDateRole:
+        return m_store.changeTime(change);
+    case HistoryProxyModel::HistoryActionRole:
+        return int(HistoryStore::packageState(m_store.changeAction(change)));
+    }
+    return QVariant();
+}
+
+QVariant HistoryModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+    if (section == 0 && orientation == Qt::Horizontal && role == Qt::DisplayRole) {
+        return i18nc("@title:column", "Date");
+    }
+    return QVariant();
+}
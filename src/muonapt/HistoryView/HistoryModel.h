@@ -0,0 +1,97 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef HISTORYMODEL_H
+#define HISTORYMODEL_H
+
+#include <QtCore/QAbstractItemModel>
+#include <QtCore/QAtomicInt>
+#include <QtCore/QFuture>
+#include <QtGui/QIcon>
+
+class QFileSystemWatcher;
+class QTimer;
+
+#include "HistoryStore.h"
+#include "../LogTail.h"
+
+/**
+ * Two level tree of APT's history: days, newest first, with the package
+ * changes of each day below them.
+ *
+ * The logs are parsed on a worker thread, newest file first, and each file
+ * is appended as soon as it is parsed. Display text is only built when a
+ * view asks for it.
+ *
+ * Afterwards the current log is followed: transactions written to it are
+ * read from where the last read stopped and prepended, also across a
+ * rotation of the log.
+ */
+class HistoryModel : public QAbstractItemModel
+{
+    Q_OBJECT
+public:
+    enum {
+        PackageRole = Qt::UserRole + 3
+    };
+
+    explicit HistoryModel(QObject *parent = nullptr);
+    ~HistoryModel();
+
+    /// Starts reading the logs in @p directory
+    void load(const QString &directory = QStringLiteral("/var/log/apt"));
+
+    const HistoryStore &store() const;
+    /// @returns the store's index of the change at @p index, -1 for days
+    int changeAt(const QModelIndex &index) const;
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &index) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+private:
+    HistoryStore m_store;
+    QIcon m_itemIcon;
+    QStringList m_actionNames;
+    QFuture<void> m_loadFuture;
+    QAtomicInt m_cancelled;
+
+    QString m_directory;
+    QFileSystemWatcher *m_watcher;
+    QTimer *m_tailTimer;
+    // Where reading the current log stopped
+    LogTail::Cursor m_tail;
+    // Days prepended so far, which keeps the internal ids of change rows stable
+    int m_newerDays;
+
+    quintptr dayId(int day) const;
+    int dayAt(quintptr id) const;
+    QString currentLog() const;
+    void appendOlder(const HistoryStore &older);
+    void prependNewer(const HistoryStore &newer);
+    void startTail(quint64 inode, qint64 offset);
+    void watchLog();
+    void readNewer();
+};
+
+#endif // HISTORYMODEL_H
@@ -20,13 +20,17 @@
 
 #include "HistoryProxyModel.h"
 
-#include <QStandardItemModel>
-#include <QStandardItem>
+#include <QDateTime>
+
+#include "HistoryModel.h"
 
 HistoryProxyModel::HistoryProxyModel(QObject *parent)
     : QSortFilterProxyModel(parent)
     , m_stateFilter((QApt::Package::State)0)
 {
+    // Days are shown when any of their changes are, which Qt works out
+    // bottom-up as rows are filtered or inserted
+    setRecursiveFilteringEnabled(true);
 }
 
 HistoryProxyModel::~HistoryProxyModel()
@@ -35,42 +39,55 @@ HistoryProxyModel::~HistoryProxyModel()
 
 void HistoryProxyModel::search(const QString &searchText)
 {
-    m_searchText = searchText;
-    invalidate();
+    m_searchText = searchText.toLower();
+    m_packageMatches.clear();
+    invalidateFilter();
 }
 
 void HistoryProxyModel::setStateFilter(QApt::Package::State state)
 {
     m_stateFilter = state;
-    invalidate();
+    invalidateFilter();
 }
 
-bool HistoryProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+bool HistoryProxyModel::packageMatches(quint32 packageId) const
 {
-    QModelIndex sourceIndex = sourceModel()->index(sourceRow, 0, sourceParent);
-        for(int i = 0 ; i < sourceModel()->rowCount(sourceIndex); i++) {
-            if (filterAcceptsRow(i, sourceIndex)) {
-                return true;
-            }
-        }
+    // Packages recur across the history, so each name is matched only once
+    if (packageId >= quint32(m_packageMatches.size())) {
+        // More names were loaded since the last search
+        m_packageMatches.fill(-1, static_cast<HistoryModel *>(sourceModel())->store().packageCount());
+    }
+
+    qint8 &match = m_packageMatches[packageId];
+    if (match == -1) {
+        const HistoryStore &store = static_cast<HistoryModel *>(sourceModel())->store();
+        match = store.packageKey(packageId).contains(m_searchText) ? 1 : 0;
+    }
+    return match == 1;
+}
 
-    //Our "main"-method
-    QStandardItem *item = static_cast<QStandardItemModel *>(sourceModel())->itemFromIndex(sourceModel()->index(sourceRow, 0, sourceParent));
+bool HistoryProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
+{
+    if (m_stateFilter == 0 && m_searchText.isEmpty()) {
+        return true;
+    }
 
-    if (!item) {
+    HistoryModel *model = static_cast<HistoryModel *>(sourceModel());
+    const int change = model->changeAt(model->index(sourceRow, 0, sourceParent));
+    if (change == -1) {
+        // A day, shown when one of its changes is
         return false;
     }
 
-    if (!m_stateFilter == 0) {
-        if ((bool)(item->data(HistoryActionRole).toInt() & m_stateFilter) == false) {
+    const HistoryStore &store = model->store();
+    if (m_stateFilter != 0) {
+        if (!(HistoryStore::packageState(store.changeAction(change)) & m_stateFilter)) {
             return false;
         }
     }
 
     if (!m_searchText.isEmpty()) {
-        if ((bool)(item->data(Qt::DisplayRole).toString().contains(m_searchText)) == false) {
-            return false;
-        }
+        return packageMatches(store.changePackageId(change));
     }
 
     return true;
@@ -78,10 +95,5 @@ bool HistoryProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourc
 
 bool HistoryProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const
 {
-    QStandardItemModel *parentModel = static_cast<QStandardItemModel *>(sourceModel());
-
-    QStandardItem *leftItem = parentModel->itemFromIndex(left);
-    QStandardItem *rightItem = parentModel->itemFromIndex(right);
-
-    return (leftItem->data(HistoryDateRole).toDateTime() > rightItem->data(HistoryDateRole).toDateTime());
+    return (left.data(HistoryDateRole).toDateTime() > right.data(HistoryDateRole).toDateTime());
 }
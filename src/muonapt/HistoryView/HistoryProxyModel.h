@@ -22,6 +22,7 @@
 #define HISTORYPROXYMODEL_H
 
 #include <QSortFilterProxyModel>
+#include <QVector>
 
 #include <QApt/Package>
 
@@ -45,8 +46,12 @@ protected:
     bool lessThan(const QModelIndex &left, const QModelIndex &right) const;
 
 private:
-    QString m_searchText;
+    QString m_searchText; // Lower case
     QApt::Package::State m_stateFilter;
+    // Whether each package name matches the search: -1 unknown, 0 or 1
+    mutable QVector<qint8> m_packageMatches;
+
+    bool packageMatches(quint32 packageId) const;
 };
 
 #endif
@@ -0,0 +1,368 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "HistoryStore.h"
+
+#include <QtCore/QDir>
+#include <QtCore/QIODevice>
+#include <QtCore/QMap>
+#include <QtCore/QRegularExpression>
+
+HistoryStore::HistoryStore()
+{
+}
+
+quint32 HistoryStore::nameId(const QString &name)
+{
+    auto it = m_nameIds.constFind(name);
+    if (it != m_nameIds.constEnd()) {
+        return *it;
+    }
+
+    const quint32 id = m_names.size();
+    m_names.append(name);
+    m_keys.append(name.toLower());
+    m_installTimes.append(0);
+    m_nameIds.insert(name, id);
+    return id;
+}
+
+int HistoryStore::addTransaction(const QDateTime &start)
+{
+    const qint64 julianDay = start.date().toJulianDay();
+    if (m_dayDates.isEmpty() || m_dayDates.last() != julianDay) {
+        m_dayDates.append(julianDay);
+        m_dayFirstChanges.append(m_changeTransactions.size());
+    }
+
+    m_transactionTimes.append(start.toMSecsSinceEpoch());
+    return m_transactionTimes.size() - 1;
+}
+
+void HistoryStore::addChange(int transaction, const QString &package, Action action)
+{
+    const quint32 id = nameId(package);
+    m_changeTransactions.append(transaction);
+    m_changeNames.append(id);
+    m_changeActions.append(action);
+    if (action == Installed) {
+        addOlderInstall(id, m_transactionTimes.at(transaction));
+    }
+}
+
+void HistoryStore::addOlderInstall(quint32 id, qint64 time)
+{
+    // Changes are added newest first, so the first install seen is the last one
+    if (m_installTimes.at(id) == 0) {
+        m_installTimes[id] = time;
+    }
+}
+
+HistoryStore HistoryStore::parse(QIODevice *device)
+{
+    struct Entry {
+        QDateTime start;
+        QVector<QPair<QString, Action>> changes;
+    };
+
+    static const QHash<QString, Action> actions = {
+        { QStringLiteral("Install"), Installed },
+        { QStringLiteral("Upgrade"), Upgraded },
+        { QStringLiteral("Downgrade"), Downgraded },
+        { QStringLiteral("Remove"), Removed },
+        { QStringLiteral("Purge"), Purged }
+    };
+    // Entries look like "name:arch (version, automatic)"
+    static const QRegularExpression entrySeparator(QStringLiteral("\\),\\s*"));
+
+    // The log is oldest first
+    QVector<Entry> entries;
+    while (!device->atEnd()) {
+        const QString line = QString::fromUtf8(device->readLine()).trimmed();
+        const int colon = line.indexOf(QLatin1String(": "));
+        if (colon == -1) {
+            continue;
+        }
+
+        const QString key = line.left(colon);
+        const QString value = line.mid(colon + 2);
+        if (key == QLatin1String("Start-Date")) {
+            Entry entry;
+            entry.start = QDateTime::fromString(value.simplified(), QStringLiteral("yyyy-MM-dd HH:mm:ss"));
+            if (entry.start.isValid()) {
+                entries.append(entry);
+            }
+            continue;
+        }
+
+        auto action = actions.constFind(key);
+        if (action == actions.constEnd() || entries.isEmpty()) {
+            continue;
+        }
+
+        const QStringList packages = value.split(entrySeparator, Qt::SkipEmptyParts);
+        for (const QString &package : packages) {
+            const QString name = package.left(package.indexOf(QLatin1String(" (")));
+            if (!name.isEmpty()) {
+                entries.last().changes.append(qMakePair(name, *action));
+            }
+        }
+    }
+
+    HistoryStore store;
+    for (int i = entries.size() - 1; i >= 0; --i) {
+        const Entry &entry = entries.at(i);
+        if (entry.changes.isEmpty()) {
+            continue;
+        }
+
+        const int transaction = store.addTransaction(entry.start);
+        for (const auto &change : entry.changes) {
+            store.addChange(transaction, change.first, change.second);
+        }
+    }
+    return store;
+}
+
+QStringList HistoryStore::logFiles(const QString &directory)
+{
+    // history.log, then history.log.1, history.log.2.gz, ... as logrotate numbers them
+    static const QRegularExpression rotated(QStringLiteral("^history\\.log\\.(\\d+)(\\.gz)?$"));
+
+    const QDir dir(directory);
+    QMap<int, QString> files;
+    if (dir.exists(QStringLiteral("history.log"))) {
+        files.insert(0, dir.filePath(QStringLiteral("history.log")));
+    }
+
+    const QStringList entries = dir.entryList({ QStringLiteral("history.log.*") }, QDir::Files);
+    for (const QString &entry : entries) {
+        const QRegularExpressionMatch match = rotated.match(entry);
+        if (match.hasMatch()) {
+            files.insert(match.captured(1).toInt(), dir.filePath(entry));
+        }
+    }
+    return files.values();
+}
+
+int HistoryStore::completeLength(const QByteArray &log)
+{
+    // APT writes the changes of a transaction when it ends, so anything
+    // after the last End-Date line is still being written
+    int end = log.size();
+    while (end > 0) {
+        const int start = log.lastIndexOf("End-Date:", end - 1);
+        if (start == -1) {
+            return 0;
+        }
+
+        const int newline = log.indexOf('\n', start);
+        if (newline != -1 && (start == 0 || log.at(start - 1) == '\n')) {
+            return newline + 1;
+        }
+        end = start;
+    }
+    return 0;
+}
+
+bool HistoryStore::isEmpty() const
+{
+    return m_changeTransactions.isEmpty();
+}
+
+int HistoryStore::dayCount() const
+{
+    return m_dayDates.size();
+}
+
+QDate HistoryStore::dayDate(int day) const
+{
+    return QDate::fromJulianDay(m_dayDates.at(day));
+}
+
+int HistoryStore::dayFirstChange(int day) const
+{
+    return m_dayFirstChanges.at(day);
+}
+
+int HistoryStore::dayChangeCount(int day) const
+{
+    const int end = day + 1 < m_dayFirstChanges.size() ? m_dayFirstChanges.at(day + 1)
+                                                       : m_changeTransactions.size();
+    return end - m_dayFirstChanges.at(day);
+}
+
+int HistoryStore::changeCount() const
+{
+    return m_changeTransactions.size();
+}
+
+QString HistoryStore::changePackage(int change) const
+{
+    return m_names.at(m_changeNames.at(change));
+}
+
+quint32 HistoryStore::changePackageId(int change) const
+{
+    return m_changeNames.at(change);
+}
+
+int HistoryStore::packageCount() const
+{
+    return m_names.size();
+}
+
+QString HistoryStore::packageKey(quint32 id) const
+{
+    return m_keys.at(id);
+}
+
+QDateTime HistoryStore::installTime(const QString &package) const
+{
+    auto it = m_nameIds.constFind(package);
+    if (it == m_nameIds.constEnd() || m_installTimes.at(*it) == 0) {
+        return QDateTime();
+    }
+    return QDateTime::fromMSecsSinceEpoch(m_installTimes.at(*it));
+}
+
+HistoryStore::Action HistoryStore::changeAction(int change) const
+{
+    return static_cast<Action>(m_changeActions.at(change));
+}
+
+QDateTime HistoryStore::changeTime(int change) const
+{
+    return QDateTime::fromMSecsSinceEpoch(m_transactionTimes.at(m_changeTransactions.at(change)));
+}
+
+QApt::Package::State HistoryStore::packageState(Action action)
+{
+    switch (action) {
+    case Installed:
+        return QApt::Package::ToInstall;
+    case Upgraded:
+        return QApt::Package::ToUpgrade;
+    case Downgraded:
+        return QApt::Package::ToDowngrade;
+    case Removed:
+        return QApt::Package::ToRemove;
+    case Purged:
+        return QApt::Package::ToPurge;
+    }
+    return QApt::Package::State(0);
+}
+
+void HistoryStore::appendOlder(const HistoryStore &older, int firstDay, int lastDay)
+{
+    if (firstDay >= lastDay) {
+        return;
+    }
+
+    const int firstChange = older.dayFirstChange(firstDay);
+    const int lastChange = older.dayFirstChange(lastDay - 1) + older.dayChangeCount(lastDay - 1);
+    const int transactionOffset = m_transactionTimes.size() - older.m_changeTransactions.at(firstChange);
+    const int changeOffset = m_changeTransactions.size() - firstChange;
+
+    for (int day = firstDay; day < lastDay; ++day) {
+        // The same day continued from the newer log
+        if (day == firstDay && !m_dayDates.isEmpty() && m_dayDates.last() == older.m_dayDates.at(day)) {
+            continue;
+        }
+        m_dayDates.append(older.m_dayDates.at(day));
+        m_dayFirstChanges.append(older.m_dayFirstChanges.at(day) + changeOffset);
+    }
+
+    const int firstTransaction = older.m_changeTransactions.at(firstChange);
+    const int lastTransaction = older.m_changeTransactions.at(lastChange - 1);
+    for (int t = firstTransaction; t <= lastTransaction; ++t) {
+        m_transactionTimes.append(older.m_transactionTimes.at(t));
+    }
+
+    for (int change = firstChange; change < lastChange; ++change) {
+        const quint32 id = nameId(older.changePackage(change));
+        m_changeTransactions.append(older.m_changeTransactions.at(change) + transactionOffset);
+        m_changeNames.append(id);
+        m_changeActions.append(older.m_changeActions.at(change));
+        if (older.m_changeActions.at(change) == Installed) {
+            addOlderInstall(id, m_transactionTimes.at(m_changeTransactions.last()));
+        }
+    }
+}
+
+void HistoryStore::prependNewer(const HistoryStore &newer, int firstDay, int lastDay)
+{
+    if (firstDay >= lastDay) {
+        return;
+    }
+
+    const int firstChange = newer.dayFirstChange(firstDay);
+    const int lastChange = newer.dayFirstChange(lastDay - 1) + newer.dayChangeCount(lastDay - 1);
+    const int firstTransaction = newer.m_changeTransactions.at(firstChange);
+    const int lastTransaction = newer.m_changeTransactions.at(lastChange - 1);
+    const int changeCount = lastChange - firstChange;
+    const int transactionCount = lastTransaction - firstTransaction + 1;
+
+    for (int &transaction : m_changeTransactions) {
+        transaction += transactionCount;
+    }
+    for (int &first : m_dayFirstChanges) {
+        first += changeCount;
+    }
+
+    // The same day continued in the newer log
+    if (!m_dayDates.isEmpty() && m_dayDates.first() == newer.m_dayDates.at(lastDay - 1)) {
+        m_dayDates.removeFirst();
+        m_dayFirstChanges.removeFirst();
+    }
+
+    QVector<qint64> dayDates;
+    QVector<int> dayFirstChanges;
+    for (int day = firstDay; day < lastDay; ++day) {
+        dayDates.append(newer.m_dayDates.at(day));
+        dayFirstChanges.append(newer.m_dayFirstChanges.at(day) - firstChange);
+    }
+    m_dayDates = dayDates + m_dayDates;
+    m_dayFirstChanges = dayFirstChanges + m_dayFirstChanges;
+
+    m_transactionTimes = newer.m_transactionTimes.mid(firstTransaction, transactionCount) + m_transactionTimes;
+
+    QVector<int> changeTransactions;
+    QVector<quint32> changeNames;
+    QVector<quint8> changeActions;
+    changeTransactions.reserve(changeCount + m_changeTransactions.size());
+    changeNames.reserve(changeCount + m_changeNames.size());
+    changeActions.reserve(changeCount + m_changeActions.size());
+    for (int change = firstChange; change < lastChange; ++change) {
+        changeTransactions.append(newer.m_changeTransactions.at(change) - firstTransaction);
+        changeNames.append(nameId(newer.changePackage(change)));
+        changeActions.append(newer.m_changeActions.at(change));
+    }
+    m_changeTransactions = changeTransactions + m_changeTransactions;
+    m_changeNames = changeNames + m_changeNames;
+    m_changeActions = changeActions + m_changeActions;
+
+    // Oldest first, so the newest install of a package wins
+    for (int change = changeCount - 1; change >= 0; --change) {
+        if (m_changeActions.at(change) == Installed) {
+            m_installTimes[m_changeNames.at(change)] = m_transactionTimes.at(m_changeTransactions.at(change));
+        }
+    }
+}
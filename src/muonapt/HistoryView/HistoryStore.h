@@ -0,0 +1,113 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef HISTORYSTORE_H
+#define HISTORYSTORE_H
+
+#include <QtCore/QDateTime>
+#include <QtCore/QHash>
+#include <QtCore/QStringList>
+#include <QtCore/QVector>
+
+#include <QApt/Package>
+
+class QIODevice;
+
+/**
+ * Package changes recorded in APT's history log, newest first.
+ *
+ * Changes are kept column by column: the transaction, interned package
+ * name and action of each change, and the start time of each transaction.
+ * Changes are grouped into days by the local date their transaction
+ * started. Nothing meant for display is stored.
+ */
+class HistoryStore
+{
+public:
+    enum Action {
+        Installed = 0,
+        Upgraded,
+        Downgraded,
+        Removed,
+        Purged
+    };
+
+    HistoryStore();
+
+    /// Parses one log in the format of /var/log/apt/history.log
+    static HistoryStore parse(QIODevice *device);
+    /// The current and rotated logs in @p directory, newest first
+    static QStringList logFiles(const QString &directory);
+    /// Length of @p log up to the end of its last finished transaction
+    static int completeLength(const QByteArray &log);
+
+    bool isEmpty() const;
+
+    int dayCount() const;
+    QDate dayDate(int day) const;
+    int dayChangeCount(int day) const;
+    /// Index of the first change of @p day
+    int dayFirstChange(int day) const;
+
+    int changeCount() const;
+    QString changePackage(int change) const;
+    quint32 changePackageId(int change) const;
+    Action changeAction(int change) const;
+    QDateTime changeTime(int change) const;
+
+    static QApt::Package::State packageState(Action action);
+
+    // Package names are interned, ids count up from 0
+    int packageCount() const;
+    /// Lower case name of package @p id, for case insensitive matching
+    QString packageKey(quint32 id) const;
+    /// When @p package, named as in the log, was last installed, if known
+    QDateTime installTime(const QString &package) const;
+
+    /// Appends days [@p firstDay, @p lastDay) of @p older, which must be older than ours
+    void appendOlder(const HistoryStore &older, int firstDay, int lastDay);
+    /// Prepends days [@p firstDay, @p lastDay) of @p newer, which must be newer than ours
+    void prependNewer(const HistoryStore &newer, int firstDay, int lastDay);
+
+private:
+    // Per transaction
+    QVector<qint64> m_transactionTimes; // Milliseconds since the epoch
+
+    // Per change
+    QVector<int> m_changeTransactions;
+    QVector<quint32> m_changeNames;
+    QVector<quint8> m_changeActions;
+
+    // Per day
+    QVector<qint64> m_dayDates; // Julian day
+    QVector<int> m_dayFirstChanges;
+
+    QVector<QString> m_names;
+    QVector<QString> m_keys;
+    QHash<QString, quint32> m_nameIds;
+    QVector<qint64> m_installTimes; // Per name, 0 if never installed
+
+    quint32 nameId(const QString &name);
+    int addTransaction(const QDateTime &start);
+    void addChange(int transaction, const QString &package, Action action);
+    void addOlderInstall(quint32 id, qint64 time);
+};
+
+#endif // HISTORYSTORE_H
@@ -28,20 +28,18 @@
 #include <QtWidgets/QVBoxLayout>
 #include <QtWidgets/QLineEdit>
 #include <QtWidgets/QComboBox>
-#include <QStandardItemModel>
 
 #include <KLocalizedString>
 
-#include <QApt/History>
-
+#include "HistoryModel.h"
 #include "HistoryProxyModel.h"
+#include "../QAptActions.h"
 
 HistoryView::HistoryView(QWidget *parent)
     : QWidget(parent)
 {
     QLayout *viewLayout = new QVBoxLayout(this);
     setLayout(viewLayout);
-    m_history = new QApt::History(this);
 
     QWidget *headerWidget = new QWidget(this);
     QHBoxLayout *headerLayout = new QHBoxLayout(headerWidget);
@@ -86,125 +84,10 @@ HistoryView::HistoryView(QWidget *parent)
     headerLayout->addWidget(m_searchEdit);
     headerLayout->addWidget(m_filterBox);
 
-    m_historyModel = new QStandardItemModel(this);
-    m_historyModel->setColumnCount(1);
-    m_historyModel->setHeaderData(0, Qt::Horizontal, i18nc("@title:column", "Date"));
+    // Shared, so reopening the view does not read the logs again
+    m_historyModel = QAptActions::self()->historyModel();
     m_historyView = new QTreeView(this);
 
-    QIcon itemIcon(QIcon::fromTheme("applications-other"));
-
-    QHash<QString, QString> categoryHash;
-
-    QHash<PastActions, QString> actionHash;
-    actionHash[InstalledAction] = i18nc("@info:status describes a past-tense action", "Installed");
-    actionHash[UpgradedAction] = i18nc("@info:status describes a past-tense action", "Upgraded");
-    actionHash[DowngradedAction] = i18nc("@status describes a past-tense action", "Downgraded");
-    actionHash[RemovedAction] = i18nc("@status describes a past-tense action", "Removed");
-    actionHash[PurgedAction] = i18nc("@status describes a past-tense action", "Purged");
-
-    Q_FOREACH (const QApt::HistoryItem &item, m_history->historyItems()) {
-        QDateTime startDateTime = item.startDate();
-        QString formattedTime = startDateTime.toString();
-        QString category;
-
-        QString date = startDateTime.date().toString();
-        if (categoryHash.contains(date)) {
-            category = categoryHash.value(date);
-        } else {
-            category = QLocale().toString(startDateTime.date(), QLocale::ShortFormat);
-            categoryHash[date] = category;
-        }
-
-        QStandardItem *parentItem = 0;
-
-        if (!m_categoryHash.contains(category)) {
-            parentItem = new QStandardItem;
-            parentItem->setEditable(false);
-            parentItem->setText(category);
-            parentItem->setData(startDateTime, HistoryProxyModel::HistoryDateRole);
-
-            m_historyModel->appendRow(parentItem);
-            m_categoryHash[category] = parentItem;
-        } else {
-            parentItem = m_categoryHash.value(category);
-        }
-
-        foreach (const QString &package, item.installedPackages()) {
-            QStandardItem *historyItem = new QStandardItem;
-            historyItem->setEditable(false);
-            historyItem->setIcon(itemIcon);
-
-            QString action = actionHash.value(InstalledAction);
-            QString text = i18nc("@item example: muon installed at 16:00", "%1 %2 at %3",
-                                 package, action, formattedTime);
-            historyItem->setText(text);
-            historyItem->setData(startDateTime, HistoryProxyModel::HistoryDateRole);
-            historyItem->setData(QApt::Package::ToInstall, HistoryProxyModel::HistoryActionRole);
-
-            parentItem->appendRow(historyItem);
-        }
-
-        foreach (const QString &package, item.upgradedPackages()) {
-            QStandardItem *historyItem = new QStandardItem;
-            historyItem->setEditable(false);
-            historyItem->setIcon(itemIcon);
-
-            QString action = actionHash.value(UpgradedAction);
-            QString text = i18nc("@item example: muon installed at 16:00", "%1 %2 at %3",
-                                 package, action, formattedTime);
-            historyItem->setText(text);
-            historyItem->setData(startDateTime, HistoryProxyModel::HistoryDateRole);
-            historyItem->setData(QApt::Package::ToUpgrade, HistoryProxyModel::HistoryActionRole);
-
-            parentItem->appendRow(historyItem);
-        }
-
-        foreach (const QString &package, item.downgradedPackages()) {
-            QStandardItem *historyItem = new QStandardItem;
-            historyItem->setEditable(false);
-            historyItem->setIcon(itemIcon);
-
-            QString action = actionHash.value(DowngradedAction);
-            QString text = i18nc("@item example: muon installed at 16:00", "%1 %2 at %3",
-                                 package, action, formattedTime);
-            historyItem->setText(text);
-            historyItem->setData(startDateTime, HistoryProxyModel::HistoryDateRole);
-            historyItem->setData(QApt::Package::ToDowngrade, HistoryProxyModel::HistoryActionRole);
-
-            parentItem->appendRow(historyItem);
-        }
-
-        foreach (const QString &package, item.removedPackages()) {
-            QStandardItem *historyItem = new QStandardItem;
-            historyItem->setEditable(false);
-            historyItem->setIcon(itemIcon);
-
-            QString action = actionHash.value(RemovedAction);
-            QString text = i18nc("@item example: muon installed at 16:00", "%1 %2 at %3",
-                                 package, action, formattedTime);
-            historyItem->setText(text);
-            historyItem->setData(startDateTime, HistoryProxyModel::HistoryDateRole);
-            historyItem->setData(QApt::Package::ToRemove, HistoryProxyModel::HistoryActionRole);
-
-            parentItem->appendRow(historyItem);
-        }
-
-        foreach (const QString &package, item.purgedPackages()) {
-            QStandardItem *historyItem = new QStandardItem;
-            historyItem->setEditable(false);
-            historyItem->setIcon(itemIcon);
-
-            QString action = actionHash.value(PurgedAction);
-            QString text = i18nc("@item example: muon installed at 16:00", "%1 %2 at %3",
-                                 package, action, formattedTime);
-            historyItem->setText(text);
-            historyItem->setData(startDateTime, HistoryProxyModel::HistoryDateRole);
-            historyItem->setData(QApt::Package::ToPurge, HistoryProxyModel::HistoryActionRole);
-
-            parentItem->appendRow(historyItem);
-        }
-    }
-
     m_historyView->setMouseTracking(true);
     m_historyView->setVerticalScrollMode(QListView::ScrollPerPixel);
 
@@ -212,8 +95,8 @@ HistoryView::HistoryView(QWidget *parent)
     viewLayout->addWidget(m_historyView);
 
     m_proxyModel = new HistoryProxyModel(this);
+    // The model is newest first already; sorting would read every row
     m_proxyModel->setSourceModel(m_historyModel);
-    m_proxyModel->sort(0);
 
     m_historyView->setModel(m_proxyModel);
     
@@ -25,17 +25,12 @@
 
 #include <QWidget>
 
-class QStandardItem;
-class QStandardItemModel;
 class QTimer;
 class QTreeView;
 class QLineEdit;
 class QComboBox;
 
-namespace QApt {
-    class History;
-}
-
+class HistoryModel;
 class HistoryProxyModel;
 
 class HistoryView : public QWidget
@@ -48,23 +43,13 @@ public:
         UpdatesItem = 2,
         RemovalsItem = 3
     };
-    enum PastActions {
-        InvalidAction = 0,
-        InstalledAction = 1,
-        UpgradedAction = 2,
-        DowngradedAction = 3,
-        RemovedAction = 4,
-        PurgedAction = 5
-    };
     HistoryView(QWidget *parent);
 
     QSize sizeHint() const;
 
 private:
-    QApt::History *m_history;
-    QStandardItemModel *m_historyModel;
+    HistoryModel *m_historyModel;
     HistoryProxyModel *m_proxyModel;
-    QHash<QString, QStandardItem *> m_categoryHash;
 
     QLineEdit *m_searchEdit;
     QTimer *m_searchTimer;
@@ -0,0 +1,126 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "LogTail.h"
+
+// Qt includes
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+
+// KDE includes
+#include <KCompressionDevice>
+
+#include <sys/stat.h>
+
+static quint64 fileInode(const QString &path)
+{
+    struct stat info;
+    if (stat(QFile::encodeName(path).constData(), &info) != 0) {
+        return 0;
+    }
+    return info.st_ino;
+}
+
+// The rest of the log at @p path after @p cursor, once it was rotated away
+static QByteArray readRotatedRest(const QString &path, const LogTail::Cursor &cursor)
+{
+    QByteArray data;
+    const QString rotated = path + QLatin1String(".1");
+    if (fileInode(rotated) == cursor.inode) {
+        LogTail::readLog(rotated, cursor.offset, &data);
+        return data;
+    }
+
+    // APT's logrotate configuration compresses without delaycompress, so
+    // the log is usually gone to path.1.gz already. That is a new file, so
+    // only its length can tell it is not some later rotation.
+    const QString compressed = rotated + QLatin1String(".gz");
+    if (QFile::exists(compressed)) {
+        data = LogTail::readRotatedLog(compressed);
+        if (data.size() < cursor.offset) {
+            return QByteArray();
+        }
+        data.remove(0, cursor.offset);
+    }
+    return data;
+}
+
+QByteArray LogTail::readAppended(const QString &path, Cursor *cursor, CompleteLength completeLength)
+{
+    QByteArray data;
+    const quint64 inode = fileInode(path);
+    if (inode != cursor->inode) {
+        if (cursor->inode != 0) {
+            data = readRotatedRest(path, *cursor);
+            data.truncate(completeLength(data));
+        }
+        cursor->inode = inode;
+        cursor->offset = 0;
+    } else if (inode != 0 && QFileInfo(path).size() < cursor->offset) {
+        // Truncated in place
+        cursor->offset = 0;
+    }
+
+    if (inode != 0) {
+        QByteArray appended;
+        if (readLog(path, cursor->offset, &appended) == inode) {
+            appended.truncate(completeLength(appended));
+            cursor->offset += appended.size();
+            data += appended;
+        }
+    }
+    return data;
+}
+
+quint64 LogTail::readLog(const QString &path, qint64 offset, QByteArray *data)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+
+    struct stat info;
+    if (fstat(file.handle(), &info) != 0) {
+        return 0;
+    }
+
+    if (offset > 0 && !file.seek(offset)) {
+        return 0;
+    }
+    *data = file.readAll();
+    return info.st_ino;
+}
+
+QByteArray LogTail::readRotatedLog(const QString &path)
+{
+    KCompressionDevice device(path, path.endsWith(QLatin1String(".gz"))
+                              ? KCompressionDevice::GZip : KCompressionDevice::None);
+    if (!device.open(QIODevice::ReadOnly)) {
+        qWarning() << "Cannot read log" << path;
+        return QByteArray();
+    }
+    return device.readAll();
+}
+
+int LogTail::completeLines(const QByteArray &log)
+{
+    return log.lastIndexOf('\n') + 1;
+}
@@ -0,0 +1,64 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef LOGTAIL_H
+#define LOGTAIL_H
+
+#include <QByteArray>
+#include <QString>
+
+/**
+ * Reads what was appended to a log since the previous read, also across
+ * logrotate rotating it: the rest of the rotated log comes first, then
+ * the new one from its start.
+ *
+ * Reads stop at the end of the last complete record, so a record that is
+ * still being written is read whole the next time.
+ */
+class LogTail
+{
+public:
+    // How far a log was read
+    struct Cursor {
+        quint64 inode = 0;
+        qint64 offset = 0;
+    };
+
+    /// Length of @p log up to the end of its last complete record
+    using CompleteLength = int (*)(const QByteArray &log);
+
+    /**
+     * @returns what was appended to the log at @p path since @p cursor,
+     * and moves @p cursor past it
+     */
+    static QByteArray readAppended(const QString &path, Cursor *cursor, CompleteLength completeLength);
+
+    /**
+     * Reads the log at @p path from @p offset into @p data
+     * @returns the inode of the file read, 0 if it cannot be read
+     */
+    static quint64 readLog(const QString &path, qint64 offset, QByteArray *data);
+    /// Reads a whole rotated log, decompressing it if it ends in .gz
+    static QByteArray readRotatedLog(const QString &path);
+    /// Length of @p log up to the end of its last line
+    static int completeLines(const QByteArray &log);
+};
+
+#endif // LOGTAIL_H
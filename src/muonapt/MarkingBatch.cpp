@@ -0,0 +1,165 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "MarkingBatch.h"
+
+// Qt includes
+#include <QDebug>
+#include <QElapsedTimer>
+
+// Own includes
+#include "MarkingJournal.h"
+#include "QAptActions.h"
+
+MarkingBatch::MarkingBatch(QApt::Backend *backend)
+    : m_backend(backend)
+{
+}
+
+void MarkingBatch::add(QApt::Package *package, QApt::Package::State action)
+{
+    m_marks.append({ package, action });
+}
+
+bool MarkingBatch::isEmpty() const
+{
+    return m_marks.isEmpty();
+}
+
+void MarkingBatch::markAll(const QList<Mark> &marks)
+{
+    m_backend->setCompressEvents(true);
+
+    for (const Mark &mark : marks) {
+        QApt::Package *package = mark.package;
+        switch (mark.action) {
+        case QApt::Package::ToInstall:
+        case QApt::Package::ToUpgrade:
+        case QApt::Package::ToDowngrade:
+            // Which version is up to the candidate, see setVersion()
+            if (!package->availableVersion().isEmpty()) {
+                package->setInstall();
+            }
+            break;
+        case QApt::Package::ToReInstall:
+            if (package->isInstalled()) {
+                package->setReInstall();
+            }
+            break;
+        case QApt::Package::ToRemove:
+            package->setRemove();
+            break;
+        case QApt::Package::ToPurge:
+            package->setPurge();
+            break;
+        case QApt::Package::ToKeep:
+            package->setKeep();
+            break;
+        default:
+            break;
+        }
+    }
+
+    m_backend->setCompressEvents(false);
+}
+
+void MarkingBatch::apply()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    m_failures.clear();
+    MarkingJournal *journal = QAptActions::self()->journal();
+    journal->checkpoint();
+    m_savedState = journal->checkpointState();
+
+    markAll(m_marks);
+
+    if (!m_backend->isBroken()) {
+        qDebug() << "Marked" << m_marks.size() << "packages in" << timer.elapsed() << "ms";
+        return;
+    }
+
+    if (m_marks.size() == 1) {
+        const Mark &mark = m_marks.first();
+        m_failures.append({ mark.package, mark.package->brokenReason() });
+        m_backend->restoreCacheState(m_savedState);
+        return;
+    }
+
+    // Bisect: mark each half on top of what already went in cleanly and
+    // split the halves that break, down to the single marks at fault.
+    // Takes O(k log n) rounds of marking for k culprits among n marks.
+    m_backend->restoreCacheState(m_savedState);
+    QApt::CacheState accepted = m_savedState;
+    const int half = m_marks.size() / 2;
+    QList<QList<Mark>> groups = { m_marks.mid(0, half), m_marks.mid(half) };
+    int rounds = 1;
+    while (!groups.isEmpty()) {
+        const QList<Mark> group = groups.takeFirst();
+        markAll(group);
+        ++rounds;
+
+        if (!m_backend->isBroken()) {
+            accepted = m_backend->currentCacheState();
+            continue;
+        }
+
+        if (group.size() == 1) {
+            // Possibly only broken together with what was accepted before
+            QApt::Package *package = group.first().package;
+            m_failures.append({ package, package->wouldBreak() ? package->brokenReason()
+                                                               : QList<QApt::MarkingErrorInfo>() });
+        } else {
+            const int groupHalf = group.size() / 2;
+            groups.prepend(group.mid(groupHalf));
+            groups.prepend(group.mid(0, groupHalf));
+        }
+        m_backend->restoreCacheState(accepted);
+    }
+
+    qDebug() << "Marked" << m_marks.size() << "packages with" << m_failures.size()
+             << "failures in" << rounds << "rounds," << timer.elapsed() << "ms";
+}
+
+void MarkingBatch::revert()
+{
+    m_backend->restoreCacheState(m_savedState);
+}
+
+QApt::CacheState MarkingBatch::savedState() const
+{
+    return m_savedState;
+}
+
+QApt::PackageList MarkingBatch::packages() const
+{
+    QApt::PackageList packages;
+    packages.reserve(m_marks.size());
+    for (const Mark &mark : m_marks) {
+        packages.append(mark.package);
+    }
+    return packages;
+}
+
+QList<MarkingBatch::Failure> MarkingBatch::failures() const
+{
+    return m_failures;
+}
@@ -0,0 +1,77 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef MARKINGBATCH_H
+#define MARKINGBATCH_H
+
+#include <QList>
+
+#include <QApt/Backend>
+#include <QApt/MarkingErrorInfo>
+#include <QApt/Package>
+
+/**
+ * Marks many packages as one operation.
+ *
+ * Marking packages one by one snapshots the cache state, checks for
+ * breakage and asks about additional changes for every package. A batch
+ * saves the cache state once, applies every mark with events compressed
+ * and checks for breakage once at the end. When the result is broken, the
+ * marks at fault are found by bisection, left out and reported together,
+ * instead of the first one undoing the whole selection.
+ */
+class MarkingBatch
+{
+public:
+    struct Failure {
+        QApt::Package *package;
+        QList<QApt::MarkingErrorInfo> reasons;
+    };
+
+    explicit MarkingBatch(QApt::Backend *backend);
+
+    /// @p action is one of ToInstall, ToUpgrade, ToDowngrade, ToReInstall, ToRemove, ToPurge or ToKeep
+    void add(QApt::Package *package, QApt::Package::State action);
+    bool isEmpty() const;
+
+    void apply();
+    /// Undoes everything apply() marked
+    void revert();
+
+    /// The cache state from before apply()
+    QApt::CacheState savedState() const;
+    QApt::PackageList packages() const;
+    QList<Failure> failures() const;
+
+private:
+    struct Mark {
+        QApt::Package *package;
+        QApt::Package::State action;
+    };
+
+    QApt::Backend *m_backend;
+    QList<Mark> m_marks;
+    QApt::CacheState m_savedState;
+    QList<Failure> m_failures;
+
+    void markAll(const QList<Mark> &marks);
+};
+
+#endif // MARKINGBATCH_H
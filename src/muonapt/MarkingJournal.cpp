@@ -0,0 +1,310 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "MarkingJournal.h"
+
+#include <algorithm>
+
+// The flags marking sets; the rest describe the package itself
+static const int s_markFlags = QApt::Package::ToKeep | QApt::Package::ToInstall | QApt::Package::NewInstall
+        | QApt::Package::ToReInstall | QApt::Package::ToUpgrade | QApt::Package::ToDowngrade
+        | QApt::Package::ToRemove | QApt::Package::ToPurge | QApt::Package::IsAuto;
+
+// Marks @p package the way @p flags say, as restoreCacheState() would
+static void applyMarks(QApt::Package *package, int flags)
+{
+    if (flags & QApt::Package::ToReInstall) {
+        package->setReInstall();
+    } else if (flags & QApt::Package::ToInstall) {
+        package->setInstall();
+    } else if (flags & QApt::Package::ToPurge) {
+        package->setPurge();
+    } else if (flags & QApt::Package::ToRemove) {
+        package->setRemove();
+    } else {
+        package->setKeep();
+    }
+    package->setAuto(flags & QApt::Package::IsAuto);
+}
+
+MarkingJournal::MarkingJournal(QObject *parent)
+    : QObject(parent)
+    , m_backend(nullptr)
+    , m_maximumSteps(20)
+    , m_dirty(false)
+    , m_suspendCount(0)
+{
+}
+
+void MarkingJournal::setBackend(QApt::Backend *backend)
+{
+    if (m_backend) {
+        disconnect(m_backend, nullptr, this, nullptr);
+    }
+
+    m_backend = backend;
+    connect(m_backend, SIGNAL(packageChanged()), this, SLOT(packageChanged()));
+}
+
+void MarkingJournal::setMaximumSteps(int steps)
+{
+    m_maximumSteps = qMax(steps, 0);
+    while (m_undoSteps.size() > m_maximumSteps) {
+        m_undoSteps.removeFirst();
+    }
+}
+
+void MarkingJournal::reset(const QApt::CacheState &state)
+{
+    if (!m_backend) {
+        return;
+    }
+
+    // Indexes are only valid for the cache they were taken from
+    m_packages = m_backend->availablePackages();
+    m_indexes.clear();
+    m_indexes.reserve(m_packages.size());
+    for (int i = 0; i < m_packages.size(); ++i) {
+        m_indexes.insert(m_packages.at(i), i);
+    }
+
+    m_original = state;
+    m_reference = state;
+    m_touched.clear();
+    m_pendingCandidates.clear();
+    m_undoSteps.clear();
+    m_redoSteps.clear();
+    m_dirty = false;
+}
+
+void MarkingJournal::packageChanged()
+{
+    if (m_suspendCount == 0) {
+        m_dirty = true;
+    }
+}
+
+bool MarkingJournal::setVersion(QApt::Package *package, const QString &version)
+{
+    const int index = m_indexes.value(package, -1);
+    if (index != -1 && m_suspendCount == 0 && !m_pendingCandidates.contains(index)) {
+        m_pendingCandidates.insert(index, package->availableVersion());
+    }
+
+    if (!package->setVersion(version)) {
+        return false;
+    }
+    m_dirty |= m_suspendCount == 0;
+    return true;
+}
+
+MarkingJournal::Step MarkingJournal::collectChanges()
+{
+    Step step;
+    // Cheap while the list is shared with the backend's own
+    if (m_backend->availablePackages() != m_packages) {
+        // The cache was reloaded behind our back
+        reset(m_backend->currentCacheState());
+        return step;
+    }
+
+    // A package can only have changed if it is marked now, was marked at
+    // the last step or got a version picked
+    QSet<int> candidates = m_touched;
+    for (QApt::Package *package : m_backend->markedPackages()) {
+        const int index = m_indexes.value(package, -1);
+        if (index != -1) {
+            candidates.insert(index);
+        }
+    }
+    for (auto it = m_pendingCandidates.constBegin(); it != m_pendingCandidates.constEnd(); ++it) {
+        candidates.insert(it.key());
+    }
+
+    QVector<int> indexes(candidates.begin(), candidates.end());
+    std::sort(indexes.begin(), indexes.end());
+    for (int i : qAsConst(indexes)) {
+        QApt::Package *package = m_packages.at(i);
+        const int flags = package->state();
+        const bool marksChanged = (flags ^ m_reference.at(i)) & s_markFlags;
+        const auto pending = m_pendingCandidates.constFind(i);
+        const bool candidateChanged = pending != m_pendingCandidates.constEnd()
+                && *pending != package->availableVersion();
+        if (!marksChanged && !candidateChanged) {
+            continue;
+        }
+
+        Change change;
+        change.index = i;
+        change.oldFlags = m_reference.at(i);
+        change.newFlags = flags;
+        if (candidateChanged) {
+            change.oldCandidate = *pending;
+            change.newCandidate = package->availableVersion();
+        }
+        step.append(change);
+
+        m_reference[i] = flags;
+        if ((flags ^ m_original.at(i)) & s_markFlags) {
+            m_touched.insert(i);
+        } else {
+            m_touched.remove(i);
+        }
+    }
+
+    m_pendingCandidates.clear();
+    return step;
+}
+
+void MarkingJournal::closeStep()
+{
+    if (!m_dirty || m_suspendCount > 0) {
+        return;
+    }
+    m_dirty = false;
+
+    const Step step = collectChanges();
+    if (step.isEmpty()) {
+        return;
+    }
+
+    // New marks make whatever was undone before unreachable
+    m_redoSteps.clear();
+    if (m_maximumSteps == 0) {
+        return;
+    }
+
+    m_undoSteps.append(step);
+    if (m_undoSteps.size() > m_maximumSteps) {
+        m_undoSteps.removeFirst();
+    }
+}
+
+void MarkingJournal::checkpoint()
+{
+    if (!m_backend) {
+        return;
+    }
+
+    if (m_suspendCount > 0) {
+        // Nothing is recorded, but checkpointState() has to be current
+        collectChanges();
+        return;
+    }
+    closeStep();
+}
+
+QApt::CacheState MarkingJournal::checkpointState() const
+{
+    return m_reference;
+}
+
+void MarkingJournal::suspend()
+{
+    if (!m_backend) {
+        return;
+    }
+
+    if (m_suspendCount++ == 0) {
+        // What the user marked so far stays a step of its own
+        closeStep();
+    }
+}
+
+void MarkingJournal::resume()
+{
+    if (!m_backend || m_suspendCount == 0) {
+        return;
+    }
+
+    if (--m_suspendCount == 0) {
+        collectChanges();
+        m_dirty = false;
+    }
+}
+
+bool MarkingJournal::canUndo() const
+{
+    return !m_undoSteps.isEmpty() || m_dirty;
+}
+
+bool MarkingJournal::canRedo() const
+{
+    // Marking anew drops them at the next checkpoint
+    return !m_redoSteps.isEmpty() && !m_dirty;
+}
+
+void MarkingJournal::replay(const Step &step, bool forward)
+{
+    m_backend->setCompressEvents(true);
+    for (const Change &change : step) {
+        QApt::Package *package = m_packages.at(change.index);
+        const QString candidate = forward ? change.newCandidate : change.oldCandidate;
+        if (!candidate.isEmpty()) {
+            package->setVersion(candidate);
+        }
+
+        const int flags = forward ? change.newFlags : change.oldFlags;
+        applyMarks(package, flags);
+
+        m_reference[change.index] = flags;
+        if ((flags ^ m_original.at(change.index)) & s_markFlags) {
+            m_touched.insert(change.index);
+        } else {
+            m_touched.remove(change.index);
+        }
+    }
+    m_backend->setCompressEvents(false);
+
+    m_pendingCandidates.clear();
+    m_dirty = false;
+}
+
+void MarkingJournal::undo()
+{
+    if (!m_backend) {
+        return;
+    }
+
+    closeStep();
+    if (m_undoSteps.isEmpty()) {
+        return;
+    }
+
+    const Step step = m_undoSteps.takeLast();
+    replay(step, false);
+    m_redoSteps.append(step);
+}
+
+void MarkingJournal::redo()
+{
+    if (!m_backend) {
+        return;
+    }
+
+    closeStep();
+    if (m_redoSteps.isEmpty()) {
+        return;
+    }
+
+    const Step step = m_redoSteps.takeLast();
+    replay(step, true);
+    m_undoSteps.append(step);
+}
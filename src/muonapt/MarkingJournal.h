@@ -0,0 +1,116 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef MARKINGJOURNAL_H
+#define MARKINGJOURNAL_H
+
+#include <QHash>
+#include <QObject>
+#include <QSet>
+#include <QVector>
+
+#include <QApt/Backend>
+
+/**
+ * Undo and redo history of package marks.
+ *
+ * QApt's own undo stack keeps a copy of the state of every package in the
+ * cache for each step. The journal keeps a single reference state and
+ * records each step as the packages whose marks changed, along with the
+ * candidate versions picked for them by hand.
+ *
+ * Only packages marked now or at the previous step can have changed, so
+ * closing a step compares just those, and undoing and redoing re-mark just
+ * the packages of the step. Versions have to be picked with setVersion()
+ * for the journal to know the one they replace.
+ *
+ * Steps are delimited the way QApt's are: checkpoint() is called before
+ * marking, and everything marked until the next checkpoint forms one step.
+ */
+class MarkingJournal : public QObject
+{
+    Q_OBJECT
+public:
+    explicit MarkingJournal(QObject *parent = nullptr);
+
+    void setBackend(QApt::Backend *backend);
+    void setMaximumSteps(int steps);
+
+    /// Forgets all steps; @p state, the current one, becomes the reference
+    void reset(const QApt::CacheState &state);
+
+    /// Closes the current step, dropping what could be redone if anything was marked
+    void checkpoint();
+    /// The cache state as of the last checkpoint, without walking the cache
+    QApt::CacheState checkpointState() const;
+
+    /// Picks @p version as the candidate of @p package within the current step
+    bool setVersion(QApt::Package *package, const QString &version);
+
+    /**
+     * Ignores marking until the matching resume(), for marks that are
+     * changed and put back again behind the user's back. The last resume()
+     * takes whatever the marks are then as the reference, without
+     * recording a step.
+     */
+    void suspend();
+    void resume();
+
+    bool canUndo() const;
+    bool canRedo() const;
+    void undo();
+    void redo();
+
+private:
+    struct Change {
+        int index; // Into the cache state
+        int oldFlags;
+        int newFlags;
+        // Both empty when the candidate did not change
+        QString oldCandidate;
+        QString newCandidate;
+    };
+    typedef QVector<Change> Step;
+
+    QApt::Backend *m_backend;
+    QApt::PackageList m_packages;
+    QHash<QApt::Package *, int> m_indexes;
+    // The cache state at the reset, and at the end of the last closed step
+    QApt::CacheState m_original;
+    QApt::CacheState m_reference;
+    // Packages whose marks differ from the original state
+    QSet<int> m_touched;
+    // Candidates before setVersion() within the current step
+    QHash<int, QString> m_pendingCandidates;
+    QList<Step> m_undoSteps;
+    QList<Step> m_redoSteps;
+    int m_maximumSteps;
+    bool m_dirty;
+    int m_suspendCount;
+
+    Step collectChanges();
+    void closeStep();
+    void replay(const Step &step, bool forward);
+
+private Q_SLOTS:
+    void packageChanged();
+};
+
+#endif // MARKINGJOURNAL_H
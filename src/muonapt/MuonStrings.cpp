@@ -23,6 +23,7 @@
 #include <KLocalizedString>
 #include <QDebug>
 
+#include <QApt/DependencyInfo>
 #include <QApt/Transaction>
 
 Q_GLOBAL_STATIC_WITH_ARGS(MuonStrings, globalMuonStrings, (0))
@@ -258,6 +259,32 @@ QString MuonStrings::archString(const QString &arch) const
     return str;
 }
 
+QString MuonStrings::dependencyTypeName(int type) const
+{
+    switch (type) {
+    case PreDepends:
+        return i18nc("@label Label preceding the package dependency list", "Pre-Depends");
+    case Depends:
+        return i18nc("@label Label preceding the package dependency list", "Depends");
+    case Recommends:
+        return i18nc("@label Label preceding the package dependency list", "Recommends");
+    case Suggests:
+        return i18nc("@label Label preceding the package dependency list", "Suggests");
+    case Enhances:
+        return i18nc("@label Label preceding the package dependency list", "Enhances");
+    case Conflicts:
+        return i18nc("@label Label preceding the package dependency list", "Conflicts");
+    case Breaks:
+        return i18nc("@label Label preceding the package dependency list", "Breaks");
+    case Replaces:
+        return i18nc("@label Label preceding the package dependency list", "Replaces");
+    case Obsoletes:
+        return i18nc("@label Label preceding the package dependency list", "Obsoletes");
+    default:
+        return QString();
+    }
+}
+
 QString MuonStrings::errorTitle(ErrorCode error) const
 {
     switch (error) {
@@ -48,6 +48,8 @@ public:
      */
     QString packageChangeStateName(QApt::Package::State state) const;
     QString archString(const QString &arch) const;
+    /** @returns the user visible name of a dependency @p type, e.g. "Depends" */
+    QString dependencyTypeName(int type) const;
     QString errorTitle(QApt::ErrorCode error) const;
     QString errorText(QApt::ErrorCode error, QApt::Transaction *trans) const;
 
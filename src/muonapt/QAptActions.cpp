@@ -20,7 +20,11 @@
 
 #include "QAptActions.h"
 #include "MuonStrings.h"
+#include "HistoryView/HistoryModel.h"
 #include "HistoryView/HistoryView.h"
+#include "MarkingJournal.h"
+#include "WhatsNewDialog.h"
+#include "../TransactionQueue.h"
 
 // Qt includes
 #include <QtCore/QDir>
@@ -58,6 +62,8 @@ QT_WARNING_POP
 QAptActions::QAptActions()
     : QObject(nullptr)
     , m_backend(nullptr)
+    , m_journal(new MarkingJournal(this))
+    , m_historyModel(nullptr)
     , m_actionsDisabled(false)
     , m_mainWindow(nullptr)
     , m_reloadWhenEditorFinished(false)
@@ -101,6 +107,8 @@ void QAptActions::setBackend(QApt::Backend* backend)
     if (!m_backend->init())
         initError();
 
+    // The journal first, so undo and redo are enabled for the current state
+    m_journal->setBackend(m_backend);
     connect(m_backend, SIGNAL(packageChanged()), this, SLOT(setActionsEnabled()));
 
     setOriginalState(m_backend->currentCacheState());
@@ -159,7 +167,6 @@ void QAptActions::setupActions()
     downloadListAction->setText(i18nc("@action", "Download Packages From List..."));
     connect(downloadListAction, SIGNAL(triggered()), this, SLOT(downloadPackagesFromList()));
     downloadListAction->setEnabled(isConnected());
-    connect(this, SIGNAL(shouldConnect(bool)), downloadListAction, SLOT(setEnabled(bool)));
     m_actions.append(downloadListAction);
 
     QAction* loadArchivesAction = actionCollection()->addAction("load_archives");
@@ -182,6 +189,13 @@ void QAptActions::setupActions()
     actionCollection()->setDefaultShortcut(historyAction, QKeySequence(Qt::CTRL | Qt::Key_H));
     connect(historyAction, SIGNAL(triggered()), this, SLOT(showHistoryDialog()));
 
+    QAction* whatsNewAction = actionCollection()->addAction("whats_new");
+    whatsNewAction->setPriority(QAction::LowPriority);
+    whatsNewAction->setIcon(QIcon::fromTheme("view-list-text"));
+    whatsNewAction->setText(i18nc("@action::inmenu", "What's New in Upgrades..."));
+    connect(whatsNewAction, SIGNAL(triggered()), this, SLOT(showWhatsNewDialog()));
+    m_actions.append(whatsNewAction);
+
     QAction *distUpgradeAction = actionCollection()->addAction("dist-upgrade");
     distUpgradeAction->setIcon(QIcon::fromTheme("system-software-update"));
     distUpgradeAction->setText(i18nc("@action", "Upgrade"));
@@ -192,6 +206,10 @@ void QAptActions::setupActions()
     connect(distUpgradeAction, SIGNAL(triggered(bool)), SLOT(launchDistUpgrade()));
 
     m_actions.append(saveInstalledAction);
+
+    connect(this, &QAptActions::shouldConnect, this, &QAptActions::updateNetworkActions);
+    connect(TransactionQueue::instance(), &TransactionQueue::aptBusyChanged,
+            this, &QAptActions::updateNetworkActions);
 }
 
 void QAptActions::setActionsEnabled(bool enabled)
@@ -205,10 +223,10 @@ void QAptActions::setActionsEnabled(bool enabled)
     if (!enabled || !m_mainWindow || !actionCollection())
         return;
 
-    actionCollection()->action("update")->setEnabled(isConnected() && enabled);
+    updateNetworkActions();
 
-    actionCollection()->action("undo")->setEnabled(m_backend && !m_backend->isUndoStackEmpty());
-    actionCollection()->action("redo")->setEnabled(m_backend && !m_backend->isRedoStackEmpty());
+    actionCollection()->action("undo")->setEnabled(m_backend && m_journal->canUndo());
+    actionCollection()->action("redo")->setEnabled(m_backend && m_journal->canRedo());
     actionCollection()->action("revert")->setEnabled(m_backend && m_backend->areChangesMarked());
     
     actionCollection()->action("save_download_list")->setEnabled(isConnected());
@@ -219,6 +237,22 @@ void QAptActions::setActionsEnabled(bool enabled)
     actionCollection()->action("dist-upgrade")->setEnabled(m_distUpgradeAvailable);
 }
 
+void QAptActions::updateNetworkActions()
+{
+    if (!m_mainWindow || !actionCollection()) {
+        return;
+    }
+
+    // The QApt worker runs one transaction at a time, and a queued commit
+    // must not have another one take over the transaction view
+    const bool enabled = !m_actionsDisabled && isConnected() && !TransactionQueue::instance()->isAptBusy();
+    for (const char *name : { "update", "download_from_list" }) {
+        if (QAction *action = actionCollection()->action(name)) {
+            action->setEnabled(enabled);
+        }
+    }
+}
+
 bool QAptActions::reloadWhenSourcesEditorFinished() const
 {
     return m_reloadWhenEditorFinished;
@@ -311,6 +345,12 @@ void QAptActions::downloadPackagesFromList()
         return;
     }
 
+    if (TransactionQueue::instance()->isAptBusy()) {
+        KMessageBox::information(m_mainWindow, i18nc("@info", "Packages can be downloaded once the queued changes have been applied."),
+                                 i18nc("@title:window", "Queue Busy"));
+        return;
+    }
+
     QString dirName = filename.left(filename.lastIndexOf('/'));
 
     setActionsEnabled(false);
@@ -328,7 +368,7 @@ void QAptActions::loadSelections()
         return;
     }
 
-    m_backend->saveCacheState();
+    m_journal->checkpoint();
     if (!m_backend->loadSelections(filename)) {
         QString text = i18nc("@label", "Could not mark changes. Please make sure "
                              "that the file is a markings file created by "
@@ -380,17 +420,17 @@ void QAptActions::loadArchives()
 
 void QAptActions::undo()
 {
-    m_backend->undo();
+    m_journal->undo();
 }
 
 void QAptActions::redo()
 {
-    m_backend->redo();
+    m_journal->redo();
 }
 
 void QAptActions::revertChanges()
 {
-    m_backend->saveCacheState();
+    m_journal->checkpoint();
     m_backend->restoreCacheState(m_originalState);
     emit changesReverted();
 }
@@ -452,7 +492,29 @@ KActionCollection* QAptActions::actionCollection()
 
 void QAptActions::setOriginalState(QApt::CacheState state)
 {
+    // Only set for a freshly (re)loaded cache, which invalidates the history
     m_originalState = state;
+    m_journal->reset(state);
+}
+
+MarkingJournal *QAptActions::journal() const
+{
+    return m_journal;
+}
+
+HistoryModel *QAptActions::historyModel()
+{
+    if (!m_historyModel) {
+        m_historyModel = new HistoryModel(this);
+        m_historyModel->load();
+        emit historyModelLoaded(m_historyModel);
+    }
+    return m_historyModel;
+}
+
+HistoryModel *QAptActions::loadedHistoryModel() const
+{
+    return m_historyModel;
 }
 
 void QAptActions::setReloadWhenEditorFinished(bool reload)
@@ -523,6 +585,16 @@ void QAptActions::showHistoryDialog()
     }
 }
 
+void QAptActions::showWhatsNewDialog()
+{
+    if (!m_whatsNewDialog) {
+        m_whatsNewDialog = new WhatsNewDialog(m_backend, mainWindow());
+        m_whatsNewDialog->show();
+    } else {
+        m_whatsNewDialog->raise();
+    }
+}
+
 void QAptActions::closeHistoryDialog()
 {
     KConfigGroup dialogConfig(KSharedConfig::openConfig("muonrc"), "HistoryDialog");
@@ -40,6 +40,9 @@ namespace QApt {
     class Transaction;
 }
 
+class HistoryModel;
+class MarkingJournal;
+
 class QAptActions : public QObject
 {
     Q_OBJECT
@@ -51,6 +54,12 @@ public:
     bool reloadWhenSourcesEditorFinished() const;
     bool isConnected() const;
     void setOriginalState(QApt::CacheState state);
+    // Undo history of the marks; checkpoint() it before marking packages
+    MarkingJournal *journal() const;
+    // APT's package history, loaded on first use and kept current afterwards
+    HistoryModel *historyModel();
+    // The history model if something already loaded it, nullptr otherwise
+    HistoryModel *loadedHistoryModel() const;
     void setReloadWhenEditorFinished(bool reload);
     void initError();
     void displayTransactionError(QApt::ErrorCode error, QApt::Transaction* trans);
@@ -61,6 +70,7 @@ signals:
     void changesReverted();
     void sourcesEditorClosed(bool reload);
     void downloadArchives(QApt::Transaction *trans);
+    void historyModelLoaded(HistoryModel *model);
     
 public slots:
     void setBackend(QApt::Backend *backend);
@@ -79,9 +89,11 @@ public slots:
     void runSourcesEditor();
     void sourcesEditorFinished(int exitStatus);
     void showHistoryDialog();
+    void showWhatsNewDialog();
     void setActionsEnabled(bool enabled = true);
 
 private slots:
+    void updateNetworkActions();
     void closeHistoryDialog();
     void checkDistUpgrade();
     void launchDistUpgrade();
@@ -92,11 +104,14 @@ private:
     
     QApt::Backend *m_backend;
     QApt::CacheState m_originalState;
+    MarkingJournal *m_journal;
+    HistoryModel *m_historyModel;
     bool m_actionsDisabled;
     KXmlGuiWindow* m_mainWindow;
     bool m_reloadWhenEditorFinished;
     
     QPointer<QDialog> m_historyDialog;
+    QPointer<QDialog> m_whatsNewDialog;
     QList<QAction *> m_actions;
     bool m_distUpgradeAvailable;
     QNetworkConfigurationManager* m_config;
@@ -0,0 +1,468 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "TransactionTimingModel.h"
+
+// Qt includes
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QMap>
+#include <QRegularExpression>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtConcurrent>
+
+// Own includes
+#include "HistoryView/HistoryStore.h"
+#include "LogTail.h"
+
+using Data = TransactionTimingModel::Data;
+using LogCursor = LogTail::Cursor;
+
+// Bump when the layout of the cached model changes
+static const quint32 s_timingCacheVersion = 2;
+
+static const char s_dpkgLog[] = "/var/log/dpkg.log";
+static const char s_historyLog[] = "/var/log/apt/history.log";
+static const char s_dpkgStatus[] = "/var/lib/dpkg/status";
+
+TransactionTimingModel *TransactionTimingModel::s_instance = nullptr;
+
+void TransactionTimingModel::Fit::add(double sampleX, double sampleY)
+{
+    n += 1;
+    x += sampleX;
+    y += sampleY;
+    xx += sampleX * sampleX;
+    xy += sampleX * sampleY;
+}
+
+bool TransactionTimingModel::Fit::isValid() const
+{
+    // A handful of samples spread over more than one x
+    return n >= 10 && n * xx - x * x > 0;
+}
+
+double TransactionTimingModel::Fit::at(double atX) const
+{
+    const double slope = (n * xy - x * y) / (n * xx - x * x);
+    return (y - slope * x) / n + slope * atX;
+}
+
+void TransactionTimingModel::PackageTiming::add(double sample)
+{
+    // A plain mean at first, then one that follows recent transactions
+    ++count;
+    seconds += (sample - seconds) / qMin<quint32>(count, 8);
+}
+
+QDataStream &operator<<(QDataStream &stream, const TransactionTimingModel::Fit &fit)
+{
+    return stream << fit.n << fit.x << fit.y << fit.xx << fit.xy;
+}
+
+QDataStream &operator>>(QDataStream &stream, TransactionTimingModel::Fit &fit)
+{
+    return stream >> fit.n >> fit.x >> fit.y >> fit.xx >> fit.xy;
+}
+
+QDataStream &operator<<(QDataStream &stream, const TransactionTimingModel::PackageTiming &timing)
+{
+    return stream << timing.count << timing.seconds;
+}
+
+QDataStream &operator>>(QDataStream &stream, TransactionTimingModel::PackageTiming &timing)
+{
+    return stream >> timing.count >> timing.seconds;
+}
+
+QDataStream &operator<<(QDataStream &stream, const LogCursor &cursor)
+{
+    return stream << cursor.inode << cursor.offset;
+}
+
+QDataStream &operator>>(QDataStream &stream, LogCursor &cursor)
+{
+    return stream >> cursor.inode >> cursor.offset;
+}
+
+static QString timingCachePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+            + QLatin1String("/transaction-timing");
+}
+
+static bool readTimingCache(Data *data)
+{
+    QFile file(timingCachePath());
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    quint32 version = 0;
+    stream >> version;
+    if (version != s_timingCacheVersion) {
+        return false;
+    }
+
+    Data cached;
+    stream >> cached.seeded >> cached.dpkgLog >> cached.historyLog
+           >> cached.installs >> cached.removals >> cached.anyInstall >> cached.anyRemoval
+           >> cached.sizeFit >> cached.changesFit
+           >> cached.lastLineTime >> cached.pendingSeconds >> cached.pendingInstalls >> cached.pendingRemovals;
+    if (stream.status() != QDataStream::Ok) {
+        return false;
+    }
+
+    *data = cached;
+    return true;
+}
+
+static void writeTimingCache(const Data &data)
+{
+    QDir().mkpath(QFileInfo(timingCachePath()).absolutePath());
+
+    QSaveFile file(timingCachePath());
+    if (!file.open(QIODevice::WriteOnly)) {
+        return;
+    }
+
+    QDataStream stream(&file);
+    stream << s_timingCacheVersion
+           << data.seeded << data.dpkgLog << data.historyLog
+           << data.installs << data.removals << data.anyInstall << data.anyRemoval
+           << data.sizeFit << data.changesFit
+           << data.lastLineTime << data.pendingSeconds << data.pendingInstalls << data.pendingRemovals;
+    file.commit();
+}
+
+// The logs logrotate made of @p path, oldest first
+static QStringList rotatedLogs(const QString &path)
+{
+    const QFileInfo info(path);
+    const QRegularExpression rotated(QLatin1Char('^') + QRegularExpression::escape(info.fileName())
+                                     + QLatin1String("\\.(\\d+)(\\.gz)?$"));
+
+    QMap<int, QString> files;
+    const QStringList entries = info.dir().entryList({ info.fileName() + QLatin1String(".*") }, QDir::Files);
+    for (const QString &entry : entries) {
+        const QRegularExpressionMatch match = rotated.match(entry);
+        if (match.hasMatch()) {
+            files.insert(-match.captured(1).toInt(), info.dir().filePath(entry));
+        }
+    }
+    return files.values();
+}
+
+// Lines look like "2024-05-01 12:00:00 status installed foo:amd64 1.0"
+static void parseDpkgLog(const QByteArray &log, Data *data, QHash<QString, double> *installs)
+{
+    // A longer gap is someone answering a prompt rather than dpkg working
+    static const qint64 maximumGap = 600;
+
+    int start = 0;
+    while (start < log.size()) {
+        int end = log.indexOf('\n', start);
+        if (end == -1) {
+            end = log.size();
+        }
+        const QList<QByteArray> fields = log.mid(start, end - start).split(' ');
+        start = end + 1;
+        if (fields.size() < 4) {
+            continue;
+        }
+
+        const QDateTime time = QDateTime::fromString(QString::fromLatin1(fields.at(0) + ' ' + fields.at(1)),
+                                                     QStringLiteral("yyyy-MM-dd HH:mm:ss"));
+        if (!time.isValid()) {
+            continue;
+        }
+
+        const QByteArray &type = fields.at(2);
+        if (type == "startup") {
+            // Nothing is charged for the time between two runs of dpkg
+            data->lastLineTime = 0;
+            continue;
+        }
+
+        QByteArray package;
+        if (type == "status" && fields.size() >= 5) {
+            package = fields.at(4);
+        } else if (type == "install" || type == "upgrade" || type == "configure"
+                   || type == "trigproc" || type == "remove" || type == "purge") {
+            package = fields.at(3);
+        } else {
+            continue;
+        }
+
+        // Timings are per package name, whatever the architecture
+        const int colon = package.indexOf(':');
+        const QString name = QString::fromUtf8(colon == -1 ? package : package.left(colon));
+        const qint64 seconds = time.toSecsSinceEpoch();
+        if (data->lastLineTime != 0) {
+            const qint64 gap = seconds - data->lastLineTime;
+            if (gap >= 0 && gap <= maximumGap) {
+                data->pendingSeconds[name] += gap;
+            }
+        }
+        data->lastLineTime = seconds;
+
+        if (type == "remove" || type == "purge") {
+            data->pendingRemovals.insert(name);
+        } else if (type == "install" || type == "upgrade" || type == "configure") {
+            data->pendingInstalls.insert(name);
+        } else if (type == "status") {
+            const QByteArray &state = fields.at(3);
+            if (state != "installed" && state != "not-installed" && state != "config-files") {
+                continue;
+            }
+
+            const double taken = data->pendingSeconds.take(name);
+            if (data->pendingRemovals.remove(name)) {
+                data->removals[name].add(taken);
+                data->anyRemoval.add(taken);
+                data->pendingInstalls.remove(name);
+            } else if (data->pendingInstalls.remove(name)) {
+                data->installs[name].add(taken);
+                data->anyInstall.add(taken);
+                installs->insert(name, taken);
+            }
+            // Otherwise it settles after trigger processing alone, whose
+            // time is part of the cost of a transaction, not of installing
+            // the package that owns the trigger
+        }
+    }
+}
+
+// Transactions start with a Start-Date line and end with an End-Date line
+static void parseHistoryLog(const QByteArray &log, Data *data)
+{
+    static const QStringList actions = {
+        QStringLiteral("Install"), QStringLiteral("Reinstall"), QStringLiteral("Upgrade"),
+        QStringLiteral("Downgrade"), QStringLiteral("Remove"), QStringLiteral("Purge")
+    };
+    // Entries look like "name:arch (version, automatic)"
+    static const QRegularExpression entrySeparator(QStringLiteral("\\),\\s*"));
+
+    QDateTime start;
+    int changes = 0;
+    const QList<QByteArray> lines = log.split('\n');
+    for (const QByteArray &rawLine : lines) {
+        const QString line = QString::fromUtf8(rawLine).trimmed();
+        const int colon = line.indexOf(QLatin1String(": "));
+        if (colon == -1) {
+            continue;
+        }
+
+        const QString key = line.left(colon);
+        const QString value = line.mid(colon + 2).simplified();
+        if (key == QLatin1String("Start-Date")) {
+            start = QDateTime::fromString(value, QStringLiteral("yyyy-MM-dd HH:mm:ss"));
+            changes = 0;
+        } else if (key == QLatin1String("End-Date")) {
+            const QDateTime end = QDateTime::fromString(value, QStringLiteral("yyyy-MM-dd HH:mm:ss"));
+            if (start.isValid() && end.isValid() && changes > 0 && start <= end) {
+                data->changesFit.add(changes, start.secsTo(end));
+            }
+            start = QDateTime();
+        } else if (actions.contains(key)) {
+            changes += value.split(entrySeparator, Qt::SkipEmptyParts).size();
+        }
+    }
+}
+
+// Installed sizes in KiB of the installed packages among @p names
+static QHash<QString, qint64> installedSizes(const QSet<QString> &names)
+{
+    QHash<QString, qint64> sizes;
+    QFile file(QString::fromLatin1(s_dpkgStatus));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return sizes;
+    }
+
+    QString package;
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine();
+        if (line.startsWith("Package: ")) {
+            package = QString::fromUtf8(line.mid(9).trimmed());
+        } else if (line.startsWith("Installed-Size: ") && names.contains(package)) {
+            sizes.insert(package, line.mid(16).trimmed().toLongLong());
+        }
+    }
+    return sizes;
+}
+
+static Data updateData(Data data, bool readCache)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    if (readCache && !readTimingCache(&data)) {
+        data = Data();
+    }
+
+    const LogCursor dpkgCursor = data.dpkgLog;
+    const LogCursor historyCursor = data.historyLog;
+    const bool seeded = data.seeded;
+    qint64 bytes = 0;
+
+    QHash<QString, double> installs;
+    if (!data.seeded) {
+        // Everything before the current logs, read once
+        for (const QString &path : rotatedLogs(QString::fromLatin1(s_dpkgLog))) {
+            const QByteArray log = LogTail::readRotatedLog(path);
+            bytes += log.size();
+            parseDpkgLog(log, &data, &installs);
+        }
+        for (const QString &path : rotatedLogs(QString::fromLatin1(s_historyLog))) {
+            const QByteArray log = LogTail::readRotatedLog(path);
+            bytes += log.size();
+            parseHistoryLog(log, &data);
+        }
+        data.seeded = true;
+    }
+
+    const QByteArray dpkgLog = LogTail::readAppended(QString::fromLatin1(s_dpkgLog), &data.dpkgLog,
+                                                     LogTail::completeLines);
+    parseDpkgLog(dpkgLog, &data, &installs);
+    const QByteArray historyLog = LogTail::readAppended(QString::fromLatin1(s_historyLog), &data.historyLog,
+                                                        HistoryStore::completeLength);
+    parseHistoryLog(historyLog, &data);
+    bytes += dpkgLog.size() + historyLog.size();
+
+    if (!installs.isEmpty()) {
+        const QSet<QString> names(installs.keyBegin(), installs.keyEnd());
+        const QHash<QString, qint64> sizes = installedSizes(names);
+        for (auto it = sizes.constBegin(); it != sizes.constEnd(); ++it) {
+            data.sizeFit.add(it.value() / 1024.0, installs.value(it.key()));
+        }
+    }
+
+    if (data.seeded != seeded
+            || data.dpkgLog.inode != dpkgCursor.inode || data.dpkgLog.offset != dpkgCursor.offset
+            || data.historyLog.inode != historyCursor.inode || data.historyLog.offset != historyCursor.offset) {
+        writeTimingCache(data);
+        qDebug() << "Transaction timings updated from" << bytes << "bytes of logs in" << timer.elapsed() << "ms";
+    }
+    return data;
+}
+
+TransactionTimingModel *TransactionTimingModel::instance()
+{
+    if (!s_instance) {
+        s_instance = new TransactionTimingModel();
+    }
+    return s_instance;
+}
+
+TransactionTimingModel::TransactionTimingModel(QObject *parent)
+    : QObject(parent)
+    , m_ready(false)
+    , m_updatePending(false)
+    , m_watcher(new QFutureWatcher<Data>(this))
+{
+    connect(m_watcher, &QFutureWatcher<Data>::finished, this, &TransactionTimingModel::updateFinished);
+}
+
+TransactionTimingModel::~TransactionTimingModel()
+{
+    m_watcher->waitForFinished();
+}
+
+void TransactionTimingModel::update()
+{
+    if (m_watcher->isRunning()) {
+        m_updatePending = true;
+        return;
+    }
+
+    m_watcher->setFuture(QtConcurrent::run(updateData, m_data, !m_ready));
+}
+
+void TransactionTimingModel::updateFinished()
+{
+    m_data = m_watcher->result();
+    m_ready = true;
+    emit updated();
+
+    if (m_updatePending) {
+        m_updatePending = false;
+        update();
+    }
+}
+
+bool TransactionTimingModel::isReady() const
+{
+    return m_ready;
+}
+
+qint64 TransactionTimingModel::estimate(const QApt::PackageList &packages)
+{
+    if (!m_ready) {
+        // Loaded on first use, so nothing is read at startup
+        if (!m_watcher->isRunning()) {
+            update();
+        }
+        return -1;
+    }
+
+    if (m_data.anyInstall.count == 0 && m_data.anyRemoval.count == 0) {
+        return -1;
+    }
+
+    double seconds = 0;
+    int changes = 0;
+    for (QApt::Package *package : packages) {
+        const int state = package->state();
+        if (state & (QApt::Package::ToRemove | QApt::Package::ToPurge)) {
+            auto it = m_data.removals.constFind(package->name());
+            seconds += it != m_data.removals.constEnd() ? it->seconds : m_data.anyRemoval.seconds;
+        } else if (state & (QApt::Package::ToInstall | QApt::Package::ToReInstall
+                            | QApt::Package::ToUpgrade | QApt::Package::ToDowngrade)) {
+            auto it = m_data.installs.constFind(package->name());
+            if (it != m_data.installs.constEnd()) {
+                seconds += it->seconds;
+            } else if (m_data.sizeFit.isValid()) {
+                seconds += qMax(0.0, m_data.sizeFit.at(package->availableInstalledSize() / 1048576.0));
+            } else {
+                seconds += m_data.anyInstall.seconds;
+            }
+        } else {
+            continue;
+        }
+        ++changes;
+    }
+
+    if (changes == 0) {
+        return -1;
+    }
+
+    // What a transaction takes besides its packages, like running triggers
+    if (m_data.changesFit.isValid()) {
+        seconds += qMax(0.0, m_data.changesFit.at(0));
+    }
+    return qRound64(seconds);
+}
@@ -0,0 +1,121 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef TRANSACTIONTIMINGMODEL_H
+#define TRANSACTIONTIMINGMODEL_H
+
+#include <QFutureWatcher>
+#include <QHash>
+#include <QObject>
+#include <QSet>
+
+#include <QApt/Package>
+
+#include "LogTail.h"
+
+/**
+ * Predicts how long applying changes takes from how long past transactions took.
+ *
+ * dpkg's log gives the time spent on each package: the time between two of
+ * its lines is charged to the package named on the later one, until that
+ * package settles as installed or removed. Packages without a record of
+ * their own are predicted from their installed size, fitted over those with
+ * one. APT's history log gives the fixed cost of a transaction, fitted
+ * against its number of changes.
+ *
+ * The logs are read on a worker thread from where the previous update
+ * stopped, and what was learnt is cached, so no log line is read twice.
+ */
+class TransactionTimingModel : public QObject
+{
+    Q_OBJECT
+public:
+    // Least squares fit of a line through (x, y) samples
+    struct Fit {
+        double n = 0;
+        double x = 0;
+        double y = 0;
+        double xx = 0;
+        double xy = 0;
+
+        void add(double sampleX, double sampleY);
+        bool isValid() const;
+        double at(double atX) const;
+    };
+
+    // Running mean of the seconds one package took
+    struct PackageTiming {
+        quint32 count = 0;
+        double seconds = 0;
+
+        void add(double sample);
+    };
+
+    struct Data {
+        bool seeded = false; // Rotated logs were read
+        LogTail::Cursor dpkgLog;
+        LogTail::Cursor historyLog;
+
+        QHash<QString, PackageTiming> installs;
+        QHash<QString, PackageTiming> removals;
+        PackageTiming anyInstall;
+        PackageTiming anyRemoval;
+        Fit sizeFit; // Seconds against installed MiB
+        Fit changesFit; // Seconds of a transaction against its number of changes
+
+        // Packages dpkg is still working on when the log was last read
+        qint64 lastLineTime = 0; // Seconds since the epoch, 0 after a dpkg startup
+        QHash<QString, double> pendingSeconds;
+        // Installed, upgraded or configured rather than only running triggers
+        QSet<QString> pendingInstalls;
+        QSet<QString> pendingRemovals;
+    };
+
+    static TransactionTimingModel *instance();
+    ~TransactionTimingModel();
+
+    /// Reads what was logged since the last update; emits updated() when done
+    void update();
+    bool isReady() const;
+
+    /**
+     * @returns the expected seconds to apply the changes marked on
+     * @p packages, or -1 when nothing is known yet
+     */
+    qint64 estimate(const QApt::PackageList &packages);
+
+private:
+    explicit TransactionTimingModel(QObject *parent = nullptr);
+
+    static TransactionTimingModel *s_instance;
+
+    Data m_data;
+    bool m_ready;
+    bool m_updatePending;
+    QFutureWatcher<Data> *m_watcher;
+
+private Q_SLOTS:
+    void updateFinished();
+
+Q_SIGNALS:
+    void updated();
+};
+
+#endif // TRANSACTIONTIMINGMODEL_H
@@ -0,0 +1,227 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#include "WhatsNewDialog.h"
+
+// Qt includes
+#include <QDialogButtonBox>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListView>
+#include <QSortFilterProxyModel>
+#include <QSplitter>
+#include <QStandardItemModel>
+#include <QTextBrowser>
+#include <QVBoxLayout>
+
+// KDE includes
+#include <KLocalizedString>
+
+// QApt includes
+#include <QApt/Backend>
+#include <QApt/Changelog>
+#include <QApt/Package>
+
+// Own includes
+#include "ChangelogCache.h"
+
+// Changelogs fetched at the same time; mirrors throttle parallel requests
+static const int s_maxParallelRequests = 6;
+
+static QString requestKey(const QString &source, const QString &version)
+{
+    return source + QLatin1Char('_') + version;
+}
+
+WhatsNewDialog::WhatsNewDialog(QApt::Backend *backend, QWidget *parent)
+    : QDialog(parent)
+    , m_finished(0)
+    , m_failed(0)
+{
+    setWindowTitle(i18nc("@title:window", "What's New"));
+    setWindowIcon(QIcon::fromTheme("view-list-text"));
+    setAttribute(Qt::WA_DeleteOnClose);
+    resize(800, 500);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+
+    m_searchEdit = new QLineEdit(this);
+    m_searchEdit->setPlaceholderText(i18nc("@label Line edit click message", "Search changes"));
+    m_searchEdit->setClearButtonEnabled(true);
+
+    m_model = new QStandardItemModel(this);
+    m_proxyModel = new QSortFilterProxyModel(this);
+    m_proxyModel->setSourceModel(m_model);
+    m_proxyModel->setFilterRole(SearchRole);
+    m_proxyModel->setFilterCaseSensitivity(Qt::CaseInsensitive);
+    m_proxyModel->setSortCaseSensitivity(Qt::CaseInsensitive);
+    m_proxyModel->sort(0);
+    connect(m_searchEdit, &QLineEdit::textChanged,
+            m_proxyModel, &QSortFilterProxyModel::setFilterFixedString);
+
+    m_listView = new QListView(this);
+    m_listView->setUniformItemSizes(true);
+    m_listView->setModel(m_proxyModel);
+    connect(m_listView->selectionModel(), &QItemSelectionModel::currentChanged,
+            this, &WhatsNewDialog::currentChanged);
+
+    m_changesBrowser = new QTextBrowser(this);
+
+    QSplitter *splitter = new QSplitter(this);
+    splitter->addWidget(m_listView);
+    splitter->addWidget(m_changesBrowser);
+    splitter->setStretchFactor(1, 2);
+
+    m_statusLabel = new QLabel(this);
+
+    QDialogButtonBox *box = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    connect(box, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    layout->addWidget(m_searchEdit);
+    layout->addWidget(splitter);
+    layout->addWidget(m_statusLabel);
+    layout->addWidget(box);
+
+    connect(ChangelogCache::instance(), &ChangelogCache::changelogReady,
+            this, &WhatsNewDialog::changelogReady);
+    connect(ChangelogCache::instance(), &ChangelogCache::changelogFailed,
+            this, &WhatsNewDialog::changelogFailed);
+
+    collectUpgrades(backend);
+    startRequests();
+    updateStatus();
+}
+
+void WhatsNewDialog::collectUpgrades(QApt::Backend *backend)
+{
+    // Binary packages built from the same source share one changelog
+    for (QApt::Package *package : backend->availablePackages()) {
+        if (!(package->state() & QApt::Package::Upgradeable)) {
+            continue;
+        }
+
+        const QString source = package->sourcePackage();
+        const QString key = requestKey(source, package->availableVersion());
+        auto it = m_requests.find(key);
+        if (it == m_requests.end()) {
+            Request request;
+            request.source = source;
+            request.installedVersion = package->installedVersion();
+            request.candidateVersion = package->availableVersion();
+            request.url = ChangelogCache::changelogUrl(package);
+            it = m_requests.insert(key, request);
+            m_queue.append(key);
+        }
+        it->binaries.append(package->name());
+    }
+}
+
+void WhatsNewDialog::startRequests()
+{
+    while (m_running.size() < s_maxParallelRequests && !m_queue.isEmpty()) {
+        const QString key = m_queue.takeFirst();
+        const Request &request = m_requests[key];
+        m_running.insert(key);
+        ChangelogCache::instance()->fetch(request.source, request.candidateVersion, request.url);
+    }
+}
+
+void WhatsNewDialog::changelogReady(const QString &source, const QString &version,
+                                    const QApt::Changelog &changelog)
+{
+    const QString key = requestKey(source, version);
+    if (!m_running.remove(key)) {
+        return;
+    }
+
+    const Request &request = m_requests[key];
+    QString changes;
+    for (const QApt::ChangelogEntry &entry : changelog.newEntriesSince(request.installedVersion)) {
+        changes += QLatin1String("<h3>") + entry.version().toHtmlEscaped() + QLatin1String("</h3>");
+        changes += QLatin1String("<pre>") + entry.description().toHtmlEscaped() + QLatin1String("</pre>");
+    }
+
+    addResult(request, changes, true);
+    ++m_finished;
+    startRequests();
+    updateStatus();
+}
+
+void WhatsNewDialog::changelogFailed(const QString &source, const QString &version)
+{
+    const QString key = requestKey(source, version);
+    if (!m_running.remove(key)) {
+        return;
+    }
+
+    addResult(m_requests[key], QString(), false);
+    ++m_finished;
+    ++m_failed;
+    startRequests();
+    updateStatus();
+}
+
+void WhatsNewDialog::addResult(const Request &request, const QString &changes, bool available)
+{
+    QStandardItem *item = new QStandardItem;
+    item->setEditable(false);
+    item->setText(i18nc("@item source package: installed version -> new version", "%1: %2 → %3",
+                        request.source, request.installedVersion, request.candidateVersion));
+    item->setToolTip(request.binaries.join(QLatin1String(", ")));
+
+    QString text;
+    if (!available) {
+        text = i18nc("@info", "The list of changes is not available.");
+        item->setIcon(QIcon::fromTheme("dialog-warning"));
+    } else if (changes.isEmpty()) {
+        text = i18nc("@info", "The changelog does not list any changes since the installed version.");
+    } else {
+        text = changes;
+    }
+    item->setData(text, ChangesRole);
+
+    // Let the search match package names as well as the changes themselves
+    item->setData(request.source + QLatin1Char(' ') + request.binaries.join(QLatin1Char(' '))
+                  + QLatin1Char(' ') + changes, SearchRole);
+
+    m_model->appendRow(item);
+}
+
+void WhatsNewDialog::updateStatus()
+{
+    const int total = m_requests.size();
+    if (!total) {
+        m_statusLabel->setText(i18nc("@info:status", "No upgrades are available."));
+    } else if (m_finished < total) {
+        m_statusLabel->setText(i18nc("@info:status", "Fetching changes: %1 of %2", m_finished, total));
+    } else if (m_failed) {
+        // Each part is pluralised on its own number
+        const QString upgrades = i18ncp("@info:status", "Changes for %1 upgrade", "Changes for %1 upgrades", total);
+        const QString failed = i18ncp("@info:status", "%1 could not be fetched", "%1 could not be fetched", m_failed);
+        m_statusLabel->setText(i18nc("@info:status upgrades, failed fetches", "%1, %2", upgrades, failed));
+    } else {
+        m_statusLabel->setText(i18ncp("@info:status", "Changes for %1 upgrade", "Changes for %1 upgrades", total));
+    }
+}
+
+void WhatsNewDialog::currentChanged(const QModelIndex &current)
+{
+    m_changesBrowser->setHtml(current.data(ChangesRole).toString());
+}
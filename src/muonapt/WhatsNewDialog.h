@@ -0,0 +1,94 @@
+/***************************************************************************
+ *   Copyright © 2025 Kydra Project                                        *
+ *                                                                         *
+ *   This program is free software; you can redistribute it and/or         *
+ *   modify it under the terms of the GNU General Public License as        *
+ *   published by the Free Software Foundation; either version 2 of        *
+ *   the License or (at your option) version 3 or any later version        *
+ *   accepted by the membership of KDE e.V. (or its successor approved     *
+ *   by the membership of KDE e.V.), which shall act as a proxy            *
+ *   defined in Section 14 of version 3 of the license.                    *
+ *                                                                         *
+ *   This program is distributed in the hope that it will be useful,       *
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of        *
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the         *
+ *   GNU General Public License for more details.                          *
+ *                                                                         *
+ *   You should have received a copy of the GNU General Public License     *
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>. *
+ ***************************************************************************/
+
+#ifndef WHATSNEWDIALOG_H
+#define WHATSNEWDIALOG_H
+
+#include <QDialog>
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QUrl>
+
+class QLabel;
+class QLineEdit;
+class QListView;
+class QModelIndex;
+class QSortFilterProxyModel;
+class QStandardItemModel;
+class QTextBrowser;
+
+namespace QApt {
+    class Backend;
+    class Changelog;
+}
+
+/**
+ * Lists what changed in every upgradeable package between the installed
+ * and the candidate version.
+ *
+ * Changelogs are requested through ChangelogCache a few at a time and each
+ * one is added to the list as soon as it is available.
+ */
+class WhatsNewDialog : public QDialog
+{
+    Q_OBJECT
+public:
+    explicit WhatsNewDialog(QApt::Backend *backend, QWidget *parent = nullptr);
+
+private:
+    struct Request {
+        QString source;
+        QString installedVersion;
+        QString candidateVersion;
+        QUrl url;
+        QStringList binaries;
+    };
+
+    enum {
+        ChangesRole = Qt::UserRole + 1,
+        SearchRole = Qt::UserRole + 2
+    };
+
+    QLineEdit *m_searchEdit;
+    QListView *m_listView;
+    QTextBrowser *m_changesBrowser;
+    QLabel *m_statusLabel;
+    QStandardItemModel *m_model;
+    QSortFilterProxyModel *m_proxyModel;
+
+    QHash<QString, Request> m_requests;
+    QStringList m_queue;
+    QSet<QString> m_running;
+    int m_finished;
+    int m_failed;
+
+    void collectUpgrades(QApt::Backend *backend);
+    void startRequests();
+    void addResult(const Request &request, const QString &changes, bool available);
+    void updateStatus();
+
+private Q_SLOTS:
+    void changelogReady(const QString &source, const QString &version, const QApt::Changelog &changelog);
+    void changelogFailed(const QString &source, const QString &version);
+    void currentChanged(const QModelIndex &current);
+};
+
+#endif // WHATSNEWDIALOG_H